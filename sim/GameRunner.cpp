@@ -0,0 +1,172 @@
+#include "GameRunner.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t DECISION_INTERVAL_MS = 250;  // Roughly a player's reaction time
+constexpr uint8_t GATE_BUTTON = 8;
+
+struct PolicyName {
+    Policy policy;
+    const char* name;
+};
+
+constexpr PolicyName POLICY_NAMES[] = {
+    {Policy::IDLE, "idle"},
+    {Policy::RANDOM, "random"},
+    {Policy::GIEPS, "gieps"},
+    {Policy::GREEDY, "greedy"},
+};
+
+// Scene::loadBitmap labels regions in static scratch arrays.
+std::mutex sceneLoadMutex;
+
+bool isEndState(GameState state) {
+    return state == GameState::WIN || state == GameState::FLOOD || state == GameState::BASIN_OVERFLOW;
+}
+
+class Player {
+public:
+    Player(Policy policy, GameLogic& game, uint32_t seed) : policy(policy), game(game), random(seed) {
+        memset(held, 0, sizeof(held));
+    }
+
+    void start() {
+        switch (policy) {
+            case Policy::GIEPS:
+            case Policy::GREEDY:
+                for (uint8_t i = 0; i < 8; i++) press(i, true);
+                break;
+            default:
+                press(0, true);
+                press(0, false);
+                break;
+        }
+    }
+
+    void act() {
+        switch (policy) {
+            case Policy::RANDOM:
+                if (random.next8() < 64) {
+                    uint8_t button = random.next8(GATE_BUTTON + 1);
+                    press(button, !held[button]);
+                }
+                break;
+            case Policy::GREEDY: {
+                float sewer = toFloat(game.getSewerLevel());
+                float basin = toFloat(game.getBasinLevel());
+                bool wantGate = sewer >= 0.45f && basin < 0.85f;
+                if (wantGate != held[GATE_BUTTON]) press(GATE_BUTTON, wantGate);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+private:
+    void press(uint8_t button, bool pressed) {
+        held[button] = pressed;
+        game.handleButton(button, pressed);
+    }
+
+    Policy policy;
+    GameLogic& game;
+    XorShiftRandom random;
+    bool held[GATE_BUTTON + 1];
+};
+
+}  // namespace
+
+bool parsePolicy(const char* name, Policy& policy) {
+    for (const PolicyName& entry : POLICY_NAMES) {
+        if (!strcmp(name, entry.name)) {
+            policy = entry.policy;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* policyName(Policy policy) {
+    for (const PolicyName& entry : POLICY_NAMES) {
+        if (entry.policy == policy) return entry.name;
+    }
+    return "?";
+}
+
+void OutcomeStats::add(const GameResult& result) {
+    games++;
+    if (!result.finished) {
+        timeouts++;
+    } else if (result.outcome == GameState::WIN) {
+        wins++;
+    } else {
+        if (result.outcome == GameState::FLOOD) {
+            floods++;
+        } else {
+            overflows++;
+        }
+        lossMs += result.durationMs;
+    }
+}
+
+GameResult playGame(const GameParams& params, const RunConfig& config, uint32_t seed, InputTrace* trace,
+                    const std::function<void(const GameLogic&)>& onUpdate) {
+    SimClock clock;
+    clock.setManual(0);
+    XorShiftRandom rainRandom(seed);
+    MainMatrixConfig matrixConfig;
+    Scene scene(matrixConfig, clock, rainRandom);
+    {
+        std::lock_guard<std::mutex> lock(sceneLoadMutex);
+        scene.loadDefaultScene();
+    }
+    SecondaryLEDHandler secondaryLEDs(clock);
+    GameLogic game(scene, secondaryLEDs, clock, params);
+    game.setInputTrace(trace);
+    Player player(config.policy, game, seed ^ 0xA5A5A5A5u);
+
+    player.start();
+    const uint32_t limitMs = config.maxSeconds * 1000;
+    uint32_t elapsed = 0;
+    uint32_t sinceDecision = 0;
+    while (elapsed < limitMs) {
+        clock.advance(SIM_TICK_MS);
+        elapsed += SIM_TICK_MS;
+        sinceDecision += SIM_TICK_MS;
+        if (sinceDecision >= DECISION_INTERVAL_MS) {
+            sinceDecision = 0;
+            player.act();
+        }
+        game.update();  // Steps the rain too; nothing is drawn
+        if (onUpdate) onUpdate(game);
+        if (isEndState(game.getState())) {
+            return GameResult{game.getState(), true, elapsed};
+        }
+    }
+    return GameResult{game.getState(), false, elapsed};
+}
+
+uint32_t resolveThreadCount(uint32_t requested, uint32_t jobs) {
+    uint32_t threads = requested ? requested : std::max(1u, std::thread::hardware_concurrency());
+    return std::max(1u, std::min(threads, jobs));
+}
+
+void runParallel(uint32_t count, uint32_t threads, const std::function<void(uint32_t)>& job) {
+    std::atomic<uint32_t> next(0);
+    std::vector<std::thread> workers;
+    for (uint32_t t = 0; t < threads; t++) {
+        workers.emplace_back([&] {
+            for (uint32_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+                job(i);
+            }
+        });
+    }
+    for (std::thread& worker : workers) worker.join();
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include "GameLogic.h"
+
+// Game update interval of the headless games, as on the device.
+constexpr uint32_t SIM_TICK_MS = GameConfig::TaskConfig::GAME_UPDATE_INTERVAL_MS;
+
+// Plays single headless games and spreads batches of them over worker threads.
+
+enum class Policy {
+    IDLE,    // Starts the game and never touches a button again
+    RANDOM,  // Toggles a random button now and then
+    GIEPS,   // Holds every GIEP, never opens the basin gate
+    GREEDY   // Holds every GIEP and opens the gate while the sewer runs high
+};
+
+bool parsePolicy(const char* name, Policy& policy);
+const char* policyName(Policy policy);
+
+struct RunConfig {
+    Policy policy;
+    uint32_t maxSeconds;  // Games still running by then count as timeouts
+};
+
+struct GameResult {
+    GameState outcome;
+    bool finished;        // False when the time limit hit first
+    uint32_t durationMs;  // From the first button press to the end state
+};
+
+// Outcome counts over a set of games.
+struct OutcomeStats {
+    uint32_t games = 0;
+    uint32_t wins = 0;
+    uint32_t floods = 0;
+    uint32_t overflows = 0;
+    uint32_t timeouts = 0;
+    uint64_t lossMs = 0;  // Summed time to FLOOD or BASIN_OVERFLOW
+
+    void add(const GameResult& result);
+    double rate(uint32_t count) const { return games ? static_cast<double>(count) / games : 0.0; }
+    double winRate() const { return rate(wins); }
+    double meanLossSeconds() const {
+        uint32_t losses = floods + overflows;
+        return losses ? lossMs / 1000.0 / losses : 0.0;
+    }
+};
+
+// The rain and the random policy are seeded from `seed`, so a game is fully
+// determined by its arguments. With `trace`, the player's inputs are recorded
+// into it for sim/trace_replay. With `onUpdate`, it sees the game after every
+// update.
+GameResult playGame(const GameParams& params, const RunConfig& config, uint32_t seed, InputTrace* trace = nullptr,
+                    const std::function<void(const GameLogic&)>& onUpdate = nullptr);
+
+// 0 requests one thread per core; never more threads than jobs.
+uint32_t resolveThreadCount(uint32_t requested, uint32_t jobs);
+
+// Runs job(i) for every i in [0, count) on `threads` workers. Jobs run in no
+// particular order and must only write their own outputs.
+void runParallel(uint32_t count, uint32_t threads, const std::function<void(uint32_t)>& job);
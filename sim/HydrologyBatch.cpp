@@ -0,0 +1,232 @@
+#include "HydrologyBatch.h"
+#include <algorithm>
+#include <cstring>
+
+#if !defined(HYDROLOGY_FIXED_POINT) && (defined(__AVX2__) || defined(__SSE2__))
+#include <immintrin.h>
+#define HYDROLOGY_BATCH_SIMD
+#endif
+
+using namespace GameConfig;
+
+namespace {
+
+constexpr uint8_t GIEP_COUNT = 8;
+
+#ifdef HYDROLOGY_BATCH_SIMD
+
+// The handful of float and mask operations the kernel needs, per instruction
+// set. Selects and minimums are spelled as GameLogic's ternaries (std::min,
+// clampValue) rather than with min/max instructions, so equal operands and
+// signed zeros resolve the same way.
+#ifdef __AVX2__
+struct Lanes {
+    static constexpr uint32_t WIDTH = 8;
+    using Float = __m256;
+    using Int = __m256i;
+
+    static Float load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, Float v) { _mm256_storeu_ps(p, v); }
+    static Float splat(float v) { return _mm256_set1_ps(v); }
+    static Float zero() { return _mm256_setzero_ps(); }
+    static Int loadBytes(const uint8_t* p) {
+        return _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+    }
+    static Int splatInt(int32_t v) { return _mm256_set1_epi32(v); }
+    static Float isEqual(Int a, Int b) { return _mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)); }
+    static Float hasBits(Int a, Int bits) { return isEqual(_mm256_and_si256(a, bits), bits); }
+    static Float isNonZero(Int a) { return _mm256_xor_ps(isEqual(a, _mm256_setzero_si256()), allSet()); }
+    static Float allSet() { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+    static Float isLess(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static Float select(Float mask, Float ifTrue, Float ifFalse) { return _mm256_blendv_ps(ifFalse, ifTrue, mask); }
+    static Float maskOr(Float a, Float b) { return _mm256_or_ps(a, b); }
+    static Float onlyWhere(Float mask, Float v) { return _mm256_and_ps(mask, v); }
+    static Float add(Float a, Float b) { return _mm256_add_ps(a, b); }
+    static Float sub(Float a, Float b) { return _mm256_sub_ps(a, b); }
+    static Float mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+};
+#else
+struct Lanes {
+    static constexpr uint32_t WIDTH = 4;
+    using Float = __m128;
+    using Int = __m128i;
+
+    static Float load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, Float v) { _mm_storeu_ps(p, v); }
+    static Float splat(float v) { return _mm_set1_ps(v); }
+    static Float zero() { return _mm_setzero_ps(); }
+    static Int loadBytes(const uint8_t* p) {
+        int32_t packed;
+        memcpy(&packed, p, sizeof(packed));
+        __m128i bytes = _mm_cvtsi32_si128(packed);
+        __m128i words = _mm_unpacklo_epi8(bytes, _mm_setzero_si128());
+        return _mm_unpacklo_epi16(words, _mm_setzero_si128());
+    }
+    static Int splatInt(int32_t v) { return _mm_set1_epi32(v); }
+    static Float isEqual(Int a, Int b) { return _mm_castsi128_ps(_mm_cmpeq_epi32(a, b)); }
+    static Float hasBits(Int a, Int bits) { return isEqual(_mm_and_si128(a, bits), bits); }
+    static Float isNonZero(Int a) { return _mm_xor_ps(isEqual(a, _mm_setzero_si128()), allSet()); }
+    static Float allSet() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+    static Float isLess(Float a, Float b) { return _mm_cmplt_ps(a, b); }
+    static Float select(Float mask, Float ifTrue, Float ifFalse) {
+        return _mm_or_ps(_mm_and_ps(mask, ifTrue), _mm_andnot_ps(mask, ifFalse));
+    }
+    static Float maskOr(Float a, Float b) { return _mm_or_ps(a, b); }
+    static Float onlyWhere(Float mask, Float v) { return _mm_and_ps(mask, v); }
+    static Float add(Float a, Float b) { return _mm_add_ps(a, b); }
+    static Float sub(Float a, Float b) { return _mm_sub_ps(a, b); }
+    static Float mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+};
+#endif
+
+using Float = Lanes::Float;
+
+// value < low ? low : (high < value ? high : value)
+Float clampLanes(Float value, Float low, Float high) {
+    return Lanes::select(Lanes::isLess(value, low), low,
+                         Lanes::select(Lanes::isLess(high, value), high, value));
+}
+
+// std::min(a, b): (b < a) ? b : a
+Float minLanes(Float a, Float b) {
+    return Lanes::select(Lanes::isLess(b, a), b, a);
+}
+
+#endif  // HYDROLOGY_BATCH_SIMD
+
+}  // namespace
+
+HydrologyBatch::HydrologyBatch(const GameParams& params, uint32_t games)
+    : rates(params), games(games) {
+    uint32_t lanes = (games + LANE_ALIGN - 1) / LANE_ALIGN * LANE_ALIGN;
+    sewerLevel.assign(lanes, GameBalance::LEVEL_EMPTY);
+    basinLevel.assign(lanes, GameBalance::LEVEL_EMPTY);
+    weather.assign(lanes, static_cast<uint8_t>(GameState::WAITING_DRY));
+    giepMask.assign(lanes, 0);
+    gateOpen.assign(lanes, 0);
+}
+
+const char* HydrologyBatch::vectorPath() {
+#if !defined(HYDROLOGY_BATCH_SIMD)
+    return "scalar";
+#elif defined(__AVX2__)
+    return "avx2";
+#else
+    return "sse2";
+#endif
+}
+
+// Mirrors GameLogic::updateWaterLevels and GameLogic::handleBasinGate.
+void HydrologyBatch::stepScalar() {
+    for (uint32_t g = 0; g < games; g++) {
+        GameState state = static_cast<GameState>(weather[g]);
+        WaterLevel sewer = sewerLevel[g];
+        WaterLevel basin = basinLevel[g];
+
+        WaterLevel sewerIncreaseRate = GameBalance::LEVEL_EMPTY;
+        switch (state) {
+            case GameState::RAINING: sewerIncreaseRate = rates.sewerIncreaseRaining; break;
+            case GameState::HEAVY: sewerIncreaseRate = rates.sewerIncreaseHeavy; break;
+            case GameState::STORM: sewerIncreaseRate = rates.sewerIncreaseStorm; break;
+            default: break;
+        }
+
+        WaterLevel giepEffect = GameBalance::LEVEL_EMPTY;
+        for (uint8_t i = 0; i < GIEP_COUNT; i++) {
+            if ((giepMask[g] >> i) & 1) giepEffect += rates.giepEffect;
+        }
+
+        for (uint8_t substep = 0; substep < Simulation::SUBSTEPS; substep++) {
+            if (state == GameState::RAINING || state == GameState::HEAVY || state == GameState::STORM) {
+                sewer += sewerIncreaseRate - giepEffect - rates.sewerDrain;
+            } else {
+                sewer -= rates.sewerDrain;
+            }
+            sewer = clampValue(sewer, GameBalance::LEVEL_EMPTY, GameBalance::LEVEL_FULL);
+
+            if (gateOpen[g]) {
+                WaterLevel transferAmount = std::min(rates.basinGateTransfer, sewer);
+                sewer -= transferAmount;
+                basin += transferAmount;
+            }
+            basin = clampValue(basin, GameBalance::LEVEL_EMPTY, GameBalance::LEVEL_FULL);
+
+            if (gateOpen[g]) {
+                WaterLevel transferAmount = std::min(rates.basinGateTransfer * sewer, rates.basinOverflowThreshold - basin);
+                sewer -= transferAmount;
+                basin += transferAmount;
+            }
+        }
+
+        sewerLevel[g] = sewer;
+        basinLevel[g] = basin;
+    }
+}
+
+#ifdef HYDROLOGY_BATCH_SIMD
+
+// The scalar step with branches turned into per-lane masks. Inactive lanes
+// compute sewer + ((0 - 0) - drain), which equals sewer - drain exactly.
+void HydrologyBatch::step() {
+    using L = Lanes;
+    const Float empty = L::splat(GameBalance::LEVEL_EMPTY);
+    const Float full = L::splat(GameBalance::LEVEL_FULL);
+    const Float raining = L::splat(rates.sewerIncreaseRaining);
+    const Float heavy = L::splat(rates.sewerIncreaseHeavy);
+    const Float storm = L::splat(rates.sewerIncreaseStorm);
+    const Float giepEffectPerButton = L::splat(rates.giepEffect);
+    const Float drain = L::splat(rates.sewerDrain);
+    const Float gateTransfer = L::splat(rates.basinGateTransfer);
+    const Float basinOverflow = L::splat(rates.basinOverflowThreshold);
+    const L::Int rainingState = L::splatInt(static_cast<int32_t>(GameState::RAINING));
+    const L::Int heavyState = L::splatInt(static_cast<int32_t>(GameState::HEAVY));
+    const L::Int stormState = L::splatInt(static_cast<int32_t>(GameState::STORM));
+
+    for (uint32_t g = 0; g < games; g += L::WIDTH) {
+        L::Int state = L::loadBytes(&weather[g]);
+        Float isRaining = L::isEqual(state, rainingState);
+        Float isHeavy = L::isEqual(state, heavyState);
+        Float isStorm = L::isEqual(state, stormState);
+        Float active = L::maskOr(L::maskOr(isRaining, isHeavy), isStorm);
+        Float increase = L::maskOr(L::maskOr(L::onlyWhere(isRaining, raining), L::onlyWhere(isHeavy, heavy)),
+                                   L::onlyWhere(isStorm, storm));
+
+        // Adding 0 for a released button leaves the sum exact, so this is the
+        // scalar loop's running sum.
+        L::Int buttons = L::loadBytes(&giepMask[g]);
+        Float giepEffect = empty;
+        for (uint8_t i = 0; i < GIEP_COUNT; i++) {
+            Float held = L::hasBits(buttons, L::splatInt(1 << i));
+            giepEffect = L::add(giepEffect, L::onlyWhere(held, giepEffectPerButton));
+        }
+        giepEffect = L::onlyWhere(active, giepEffect);
+
+        Float sewer = L::load(&sewerLevel[g]);
+        Float basin = L::load(&basinLevel[g]);
+        Float gate = L::isNonZero(L::loadBytes(&gateOpen[g]));
+        for (uint8_t substep = 0; substep < Simulation::SUBSTEPS; substep++) {
+            sewer = L::add(sewer, L::sub(L::sub(increase, giepEffect), drain));
+            sewer = clampLanes(sewer, empty, full);
+
+            Float transferAmount = minLanes(gateTransfer, sewer);
+            sewer = L::select(gate, L::sub(sewer, transferAmount), sewer);
+            basin = L::select(gate, L::add(basin, transferAmount), basin);
+            basin = clampLanes(basin, empty, full);
+
+            transferAmount = minLanes(L::mul(gateTransfer, sewer), L::sub(basinOverflow, basin));
+            sewer = L::select(gate, L::sub(sewer, transferAmount), sewer);
+            basin = L::select(gate, L::add(basin, transferAmount), basin);
+        }
+
+        L::store(&sewerLevel[g], sewer);
+        L::store(&basinLevel[g], basin);
+    }
+}
+
+#else
+
+void HydrologyBatch::step() {
+    stepScalar();
+}
+
+#endif
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "GameLogic.h"
+
+// The per-step sewer and basin update of GameLogic (Simulation::SUBSTEPS
+// rounds of updateWaterLevels and handleBasinGate; rain impacts are not
+// modelled) for many independent games at once, stored as
+// structure-of-arrays so one vector instruction advances a lane per game.
+//
+// Float builds use AVX2 (8 games per instruction) when compiled with -mavx2,
+// otherwise SSE2 (4 games); HYDROLOGY_FIXED_POINT builds and non-x86 hosts
+// run the scalar loop. Every path performs the same operations in the same
+// order as GameLogic, so the levels match it bit for bit.
+class HydrologyBatch {
+public:
+    // Lane counts are rounded up to a multiple of this; padding lanes idle.
+    static constexpr uint32_t LANE_ALIGN = 8;
+
+    HydrologyBatch(const GameParams& params, uint32_t games);
+
+    uint32_t size() const { return games; }
+
+    // Per-game inputs, as GameLogic holds them between steps. `weather` is the
+    // current GameState; only RAINING, HEAVY and STORM raise the sewer.
+    void setWeather(uint32_t game, GameState weather) { this->weather[game] = static_cast<uint8_t>(weather); }
+    void setGIEPMask(uint32_t game, uint8_t mask) { giepMask[game] = mask; }  // Bit i: GIEP button i held
+    void setGateOpen(uint32_t game, bool open) { gateOpen[game] = open ? 0xFF : 0; }
+    void setLevels(uint32_t game, WaterLevel sewer, WaterLevel basin) {
+        sewerLevel[game] = sewer;
+        basinLevel[game] = basin;
+    }
+
+    WaterLevel getSewerLevel(uint32_t game) const { return sewerLevel[game]; }
+    WaterLevel getBasinLevel(uint32_t game) const { return basinLevel[game]; }
+
+    // One fixed step for every game, on the widest path this build has.
+    void step();
+    // The same step one game at a time, for comparison.
+    void stepScalar();
+
+    // "avx2", "sse2" or "scalar"
+    static const char* vectorPath();
+
+private:
+    const LevelRates rates;
+    uint32_t games;
+    std::vector<WaterLevel> sewerLevel;
+    std::vector<WaterLevel> basinLevel;
+    std::vector<uint8_t> weather;
+    std::vector<uint8_t> giepMask;
+    std::vector<uint8_t> gateOpen;
+};
@@ -0,0 +1,317 @@
+#include "ParamSweep.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <regex>
+#include <sstream>
+
+namespace {
+
+#define DURATION_FIELD(member, constant)                                                 \
+    {#member, constant, true, [](const GameParams& p) { return static_cast<double>(p.member); }, \
+     [](GameParams& p, double value) { p.member = static_cast<uint32_t>(value + 0.5); }}
+#define FLOAT_FIELD(member, constant)                                                    \
+    {#member, constant, false, [](const GameParams& p) { return static_cast<double>(p.member); }, \
+     [](GameParams& p, double value) { p.member = static_cast<float>(value); }}
+
+const ParamField PARAM_FIELDS[] = {
+    DURATION_FIELD(waitingRainingDuration, "WAITING_RAINING_DURATION"),
+    DURATION_FIELD(waitingDryDuration, "WAITING_DRY_DURATION"),
+    DURATION_FIELD(rainingDuration, "RAINING_DURATION"),
+    DURATION_FIELD(heavyDuration, "HEAVY_DURATION"),
+    DURATION_FIELD(stormDuration, "STORM_DURATION"),
+    DURATION_FIELD(endStateDuration, "END_STATE_DURATION"),
+    FLOAT_FIELD(sewerIncreaseRateRaining, "SEWER_INCREASE_RATE_RAINING"),
+    FLOAT_FIELD(sewerIncreaseRateHeavy, "SEWER_INCREASE_RATE_HEAVY"),
+    FLOAT_FIELD(sewerIncreaseRateStorm, "SEWER_INCREASE_RATE_STORM"),
+    FLOAT_FIELD(giepEffectStrength, "GIEP_EFFECT_STRENGTH"),
+    FLOAT_FIELD(sewerDrainRate, "SEWER_DRAIN_RATE"),
+    FLOAT_FIELD(basinGateTransferRate, "BASIN_GATE_TRANSFER_RATE"),
+    FLOAT_FIELD(rainImpactQuantum, "RAIN_IMPACT_QUANTUM"),
+    FLOAT_FIELD(sewerOverflowThreshold, "SEWER_OVERFLOW_THRESHOLD"),
+    FLOAT_FIELD(basinOverflowThreshold, "BASIN_OVERFLOW_THRESHOLD"),
+    FLOAT_FIELD(winThreshold, "WIN_THRESHOLD"),
+};
+
+#undef DURATION_FIELD
+#undef FLOAT_FIELD
+
+struct Candidate {
+    GameParams params;
+    OutcomeStats stats;
+    bool cached = false;
+};
+
+// The value as it would be written in game_config.h.
+std::string formatValue(const ParamField& field, const GameParams& params) {
+    char text[32];
+    double value = field.get(params);
+    if (field.isDuration) {
+        snprintf(text, sizeof(text), "%u", static_cast<uint32_t>(value));
+    } else {
+        snprintf(text, sizeof(text), "%.6g", value);
+        if (!strpbrk(text, ".e")) strcat(text, ".0");
+        strcat(text, "f");
+    }
+    return text;
+}
+
+// Sets a value rounded the way it will be written out, so the games run on
+// exactly the values that end up in the config and the cache key.
+void assign(const ParamField& field, GameParams& params, double value) {
+    field.set(params, value);
+    field.set(params, strtod(formatValue(field, params).c_str(), nullptr));
+}
+
+// Build flags that change the water model.
+constexpr const char* MODEL_DEFINES = ""
+#ifdef HYDROLOGY_FIXED_POINT
+    " HYDROLOGY_FIXED_POINT"
+#endif
+#ifdef SURFACE_WATER_GRID
+    " SURFACE_WATER_GRID"
+#endif
+    ;
+
+// FNV-1a over game_config.h and the model build flags, so a cache entry is
+// only reused by a build of the same model. Changes to the model code itself
+// are not seen; delete the cache after those.
+bool modelFingerprint(const std::string& configPath, uint32_t& fingerprint) {
+    std::ifstream in(configPath, std::ios::binary);
+    if (!in) {
+        fprintf(stderr, "Cannot read %s\n", configPath.c_str());
+        return false;
+    }
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    text += MODEL_DEFINES;
+    fingerprint = 2166136261u;
+    for (char c : text) {
+        fingerprint = (fingerprint ^ static_cast<uint8_t>(c)) * 16777619u;
+    }
+    return true;
+}
+
+// Identifies a candidate together with everything else that affects its games.
+std::string cacheKey(const SweepOptions& options, uint32_t fingerprint, const GameParams& params) {
+    std::ostringstream key;
+    char model[16];
+    snprintf(model, sizeof(model), "%08x", fingerprint);
+    key << model << '/' << policyName(options.run.policy) << '/' << options.gamesPerCandidate << '/' << options.seed
+        << '/' << options.run.maxSeconds;
+    for (const ParamField& field : PARAM_FIELDS) {
+        key << '/' << formatValue(field, params);
+    }
+    return key.str();
+}
+
+void loadCache(const std::string& path, std::map<std::string, OutcomeStats>& cache) {
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string key;
+        OutcomeStats stats;
+        unsigned long long lossMs = 0;
+        if (std::getline(fields, key, '\t') &&
+            fields >> stats.games >> stats.wins >> stats.floods >> stats.overflows >> stats.timeouts >> lossMs) {
+            stats.lossMs = lossMs;
+            cache[key] = stats;
+        }
+    }
+}
+
+void appendCache(const std::string& path, const std::string& key, const OutcomeStats& stats) {
+    std::ofstream out(path, std::ios::app);
+    out << key << '\t' << stats.games << '\t' << stats.wins << '\t' << stats.floods << '\t' << stats.overflows << '\t'
+        << stats.timeouts << '\t' << stats.lossMs << '\n';
+}
+
+std::vector<GameParams> gridCandidates(const SweepOptions& options) {
+    std::vector<GameParams> candidates(1, GameParams::defaults());
+    for (const SweepRange& range : options.ranges) {
+        std::vector<GameParams> expanded;
+        for (const GameParams& base : candidates) {
+            for (uint32_t i = 0; i < range.steps; i++) {
+                GameParams params = base;
+                double t = range.steps > 1 ? static_cast<double>(i) / (range.steps - 1) : 0.0;
+                assign(*range.field, params, range.min + (range.max - range.min) * t);
+                expanded.push_back(params);
+            }
+        }
+        candidates.swap(expanded);
+    }
+    return candidates;
+}
+
+std::vector<GameParams> randomCandidates(const SweepOptions& options) {
+    XorShiftRandom random(options.seed);
+    std::vector<GameParams> candidates;
+    for (uint32_t c = 0; c < options.randomCandidates; c++) {
+        GameParams params = GameParams::defaults();
+        for (const SweepRange& range : options.ranges) {
+            double t = random.next32() / 4294967295.0;
+            double value = range.min + (range.max - range.min) * t;
+            if (range.field->isDuration) value = std::round(value / 100.0) * 100.0;
+            assign(*range.field, params, value);
+        }
+        candidates.push_back(params);
+    }
+    return candidates;
+}
+
+double bandDistance(const SweepOptions& options, double winRate) {
+    if (winRate < options.targetLow) return options.targetLow - winRate;
+    if (winRate > options.targetHigh) return winRate - options.targetHigh;
+    return 0.0;
+}
+
+// Copies game_config.h with the swept constants set to the candidate's values.
+// Writes nothing when a swept constant is not found in it.
+bool writeConfig(const SweepOptions& options, const GameParams& params) {
+    std::ifstream in(options.configPath);
+    if (!in) {
+        fprintf(stderr, "Cannot read %s\n", options.configPath.c_str());
+        return false;
+    }
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::vector<const char*> unmatched;
+    for (const SweepRange& range : options.ranges) {
+        const ParamField& field = *range.field;
+        // Matches "NAME = 10000;" as well as "NAME{0.65f};"
+        std::regex pattern(std::string("(\\b") + field.constant + "\\b\\s*(=\\s*|\\{))[-0-9.eE]+f?");
+        std::string value = formatValue(field, params);
+        std::string replaced;
+        std::smatch match;
+        auto rest = text.cbegin();
+        uint32_t matches = 0;
+        while (std::regex_search(rest, text.cend(), match, pattern)) {
+            replaced.append(rest, match[0].first);
+            replaced += match[1].str() + value;
+            rest = match[0].second;
+            matches++;
+        }
+        replaced.append(rest, text.cend());
+        text.swap(replaced);
+        if (!matches) {
+            unmatched.push_back(field.constant);
+        }
+    }
+    if (!unmatched.empty()) {
+        fprintf(stderr, "No value found in %s for:", options.configPath.c_str());
+        for (const char* constant : unmatched) fprintf(stderr, " %s", constant);
+        fprintf(stderr, "\n%s not written\n", options.outputPath.c_str());
+        return false;
+    }
+    std::ofstream out(options.outputPath);
+    out << text;
+    return static_cast<bool>(out);
+}
+
+}  // namespace
+
+bool parseSweepRange(const char* spec, SweepRange& range) {
+    const char* equals = strchr(spec, '=');
+    if (!equals) return false;
+    std::string name(spec, equals - spec);
+    range.field = nullptr;
+    for (const ParamField& field : PARAM_FIELDS) {
+        if (name == field.name) range.field = &field;
+    }
+    if (!range.field) {
+        fprintf(stderr, "Unknown parameter %s. Known:", name.c_str());
+        for (const ParamField& field : PARAM_FIELDS) fprintf(stderr, " %s", field.name);
+        fprintf(stderr, "\n");
+        return false;
+    }
+    range.steps = 1;
+    int parsed = sscanf(equals + 1, "%lf:%lf:%u", &range.min, &range.max, &range.steps);
+    if (parsed == 1) range.max = range.min;
+    return parsed >= 1 && range.steps > 0;
+}
+
+int runSweep(const SweepOptions& options) {
+    uint32_t fingerprint = 0;
+    if (!modelFingerprint(options.configPath, fingerprint)) {
+        return 1;
+    }
+    std::vector<GameParams> params = options.randomCandidates ? randomCandidates(options) : gridCandidates(options);
+    std::vector<Candidate> candidates(params.size());
+    std::map<std::string, OutcomeStats> cache;
+    loadCache(options.cachePath, cache);
+
+    std::vector<uint32_t> pending;
+    for (size_t c = 0; c < candidates.size(); c++) {
+        candidates[c].params = params[c];
+        auto hit = cache.find(cacheKey(options, fingerprint, params[c]));
+        if (hit != cache.end()) {
+            candidates[c].stats = hit->second;
+            candidates[c].cached = true;
+        } else {
+            pending.push_back(c);
+        }
+    }
+
+    // Every (candidate, game) pair is a job, so a few slow candidates do not
+    // leave cores idle. Candidates share game seeds, which cuts the noise
+    // when comparing them.
+    const uint32_t games = options.gamesPerCandidate;
+    const uint32_t jobs = pending.size() * games;
+    const uint32_t threads = resolveThreadCount(options.threads, jobs);
+    std::vector<GameResult> results(jobs);
+    auto start = std::chrono::steady_clock::now();
+    runParallel(jobs, threads, [&](uint32_t job) {
+        const Candidate& candidate = candidates[pending[job / games]];
+        results[job] = playGame(candidate.params, options.run, options.seed + job % games);
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (size_t p = 0; p < pending.size(); p++) {
+        Candidate& candidate = candidates[pending[p]];
+        for (uint32_t g = 0; g < games; g++) {
+            candidate.stats.add(results[p * games + g]);
+        }
+        appendCache(options.cachePath, cacheKey(options, fingerprint, candidate.params), candidate.stats);
+    }
+
+    const double center = (options.targetLow + options.targetHigh) / 2;
+    std::vector<const Candidate*> ranked;
+    for (const Candidate& candidate : candidates) ranked.push_back(&candidate);
+    std::stable_sort(ranked.begin(), ranked.end(), [&](const Candidate* a, const Candidate* b) {
+        double da = bandDistance(options, a->stats.winRate());
+        double db = bandDistance(options, b->stats.winRate());
+        if (da != db) return da < db;
+        return std::fabs(a->stats.winRate() - center) < std::fabs(b->stats.winRate() - center);
+    });
+
+    printf("policy %s, %zu candidates (%zu cached), %u games each, target win rate %.0f-%.0f%%\n",
+           policyName(options.run.policy), candidates.size(), candidates.size() - pending.size(), games,
+           options.targetLow * 100, options.targetHigh * 100);
+    printf("%4s %6s %6s %6s %6s %7s", "rank", "win%", "flood%", "ovfl%", "tmo%", "loss s");
+    for (const SweepRange& range : options.ranges) printf("  %s", range.field->name);
+    printf("\n");
+    for (size_t r = 0; r < ranked.size() && r < options.top; r++) {
+        const Candidate& candidate = *ranked[r];
+        const OutcomeStats& stats = candidate.stats;
+        printf("%4zu %6.1f %6.1f %6.1f %6.1f %7.1f", r + 1, stats.winRate() * 100, stats.rate(stats.floods) * 100,
+               stats.rate(stats.overflows) * 100, stats.rate(stats.timeouts) * 100, stats.meanLossSeconds());
+        for (const SweepRange& range : options.ranges) {
+            printf("  %*s", static_cast<int>(strlen(range.field->name)),
+                   formatValue(*range.field, candidate.params).c_str());
+        }
+        printf("%s\n", candidate.cached ? "  (cached)" : "");
+    }
+    if (jobs) {
+        printf("%u games in %.2f s, %.0f games/s on %u threads\n", jobs, seconds, jobs / seconds, threads);
+    }
+
+    if (ranked.empty() || !writeConfig(options, ranked.front()->params)) {
+        return 1;
+    }
+    printf("Best candidate written to %s\n", options.outputPath.c_str());
+    return 0;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "GameRunner.h"
+
+// Grid or random search over GameParams, scored against a target win-rate band.
+
+// One tunable GameParams member and the game_config.h constant it comes from.
+struct ParamField {
+    const char* name;      // Same as the GameParams member
+    const char* constant;  // Name of the constant in game_config.h
+    bool isDuration;       // uint32_t milliseconds rather than a float
+    double (*get)(const GameParams& params);
+    void (*set)(GameParams& params, double value);
+};
+
+struct SweepRange {
+    const ParamField* field;
+    double min;
+    double max;
+    uint32_t steps;  // Grid points; random search ignores it
+};
+
+struct SweepOptions {
+    std::vector<SweepRange> ranges;
+    uint32_t randomCandidates = 0;  // 0: full grid over the ranges
+    double targetLow = 0.4;
+    double targetHigh = 0.6;
+    uint32_t gamesPerCandidate = 500;
+    uint32_t seed = GameConfig::Simulation::RANDOM_SEED;
+    uint32_t threads = 0;
+    RunConfig run = {Policy::GREEDY, 600};
+    uint32_t top = 10;
+    std::string cachePath = "sweep_cache.tsv";
+    std::string configPath = "src/game_config.h";
+    std::string outputPath = "game_config.tuned.h";
+};
+
+// Parses "name=min:max[:steps]".
+bool parseSweepRange(const char* spec, SweepRange& range);
+
+// Returns the process exit code.
+int runSweep(const SweepOptions& options);
@@ -0,0 +1,191 @@
+// Headless batch simulator: plays many games of GameLogic + Scene on the host,
+// faster than real time and spread across all cores, and reports how they end.
+// In sweep mode it searches GameParams for a target win rate instead.
+//
+// Build (or `pio run -e native`):
+//   g++ -std=gnu++17 -O2 -pthread -Isim/host -Isrc -DLOG_LEVEL_MAX=LOG_LEVEL_NONE
+//       sim/batch_sim.cpp sim/GameRunner.cpp sim/ParamSweep.cpp
+//       src/Scene.cpp src/RainSystem.cpp src/MatrixConfig.cpp src/DebugLogger.cpp
+//       src/SimClock.cpp src/GameLogic.cpp src/SecondaryLEDHandler.cpp src/InputTrace.cpp -o batch_sim
+//
+// Batch:
+//   ./batch_sim [--games N] [--policy idle|random|gieps|greedy] [--threads T]
+//               [--seed S] [--max-seconds M]
+//
+// Sweep (grid over every --sweep range, or --random N samples from them):
+//   ./batch_sim --sweep sewerDrainRate=0.2:0.4:5 --sweep giepEffectStrength=0.1:0.2:3
+//               [--random N] [--target 0.4:0.6] [--games N] [--top K]
+//               [--cache sweep_cache.tsv] [--config src/game_config.h] [--output game_config.tuned.h]
+//
+// Each game gets its own manual SimClock and rain seed (seed + game index), so
+// the results do not depend on the thread count.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "GameRunner.h"
+#include "ParamSweep.h"
+
+namespace {
+
+constexpr uint32_t HISTOGRAM_BUCKET_MS = 10000;
+
+struct Options {
+    uint32_t games = 2000;
+    uint32_t threads = 0;  // 0: one per core
+    uint32_t seed = GameConfig::Simulation::RANDOM_SEED;
+    RunConfig run = {Policy::GREEDY, 600};
+    bool sweep = false;
+    SweepOptions sweepOptions;
+};
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    bool gamesGiven = false;
+    SweepOptions& sweep = options.sweepOptions;
+    for (int i = 1; i < argc; i++) {
+        const char* flag = argv[i];
+        if (i + 1 >= argc) {
+            fprintf(stderr, "Missing value for %s\n", flag);
+            return false;
+        }
+        const char* value = argv[++i];
+        if (!strcmp(flag, "--games")) {
+            options.games = strtoul(value, nullptr, 0);
+            gamesGiven = true;
+        } else if (!strcmp(flag, "--threads")) {
+            options.threads = strtoul(value, nullptr, 0);
+        } else if (!strcmp(flag, "--seed")) {
+            options.seed = strtoul(value, nullptr, 0);
+        } else if (!strcmp(flag, "--max-seconds")) {
+            options.run.maxSeconds = strtoul(value, nullptr, 0);
+        } else if (!strcmp(flag, "--policy")) {
+            if (!parsePolicy(value, options.run.policy)) {
+                fprintf(stderr, "Unknown policy: %s\n", value);
+                return false;
+            }
+        } else if (!strcmp(flag, "--sweep")) {
+            SweepRange range;
+            if (!parseSweepRange(value, range)) {
+                fprintf(stderr, "Bad sweep range: %s (want name=min:max[:steps])\n", value);
+                return false;
+            }
+            sweep.ranges.push_back(range);
+            options.sweep = true;
+        } else if (!strcmp(flag, "--random")) {
+            sweep.randomCandidates = strtoul(value, nullptr, 0);
+        } else if (!strcmp(flag, "--target")) {
+            if (sscanf(value, "%lf:%lf", &sweep.targetLow, &sweep.targetHigh) != 2) {
+                fprintf(stderr, "Bad target band: %s (want low:high)\n", value);
+                return false;
+            }
+        } else if (!strcmp(flag, "--top")) {
+            sweep.top = strtoul(value, nullptr, 0);
+        } else if (!strcmp(flag, "--cache")) {
+            sweep.cachePath = value;
+        } else if (!strcmp(flag, "--config")) {
+            sweep.configPath = value;
+        } else if (!strcmp(flag, "--output")) {
+            sweep.outputPath = value;
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", flag);
+            return false;
+        }
+    }
+    if (gamesGiven) sweep.gamesPerCandidate = options.games;
+    sweep.seed = options.seed;
+    sweep.threads = options.threads;
+    sweep.run = options.run;
+    return options.games > 0;
+}
+
+double percentile(const std::vector<uint32_t>& sorted, double fraction) {
+    size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[index] / 1000.0;
+}
+
+void printDistribution(const char* label, std::vector<uint32_t> durations) {
+    if (durations.empty()) {
+        printf("%-16s -\n", label);
+        return;
+    }
+    std::sort(durations.begin(), durations.end());
+    double sum = 0;
+    for (uint32_t ms : durations) sum += ms;
+    printf("%-16s mean %6.1f s  p10 %6.1f  p50 %6.1f  p90 %6.1f  max %6.1f\n", label,
+           sum / durations.size() / 1000.0, percentile(durations, 0.1), percentile(durations, 0.5),
+           percentile(durations, 0.9), durations.back() / 1000.0);
+}
+
+void printHistogram(const std::vector<uint32_t>& durations) {
+    if (durations.empty()) return;
+    uint32_t buckets = *std::max_element(durations.begin(), durations.end()) / HISTOGRAM_BUCKET_MS + 1;
+    std::vector<uint32_t> counts(buckets, 0);
+    for (uint32_t ms : durations) counts[ms / HISTOGRAM_BUCKET_MS]++;
+    uint32_t peak = *std::max_element(counts.begin(), counts.end());
+    for (uint32_t b = 0; b < buckets; b++) {
+        int width = static_cast<int>(50.0 * counts[b] / peak + 0.5);
+        printf("  %4u-%-4u s %6u %.*s\n", b * HISTOGRAM_BUCKET_MS / 1000, (b + 1) * HISTOGRAM_BUCKET_MS / 1000,
+               counts[b], width, "##################################################");
+    }
+}
+
+int runBatch(const Options& options) {
+    const GameParams params = GameParams::defaults();
+    uint32_t threadCount = resolveThreadCount(options.threads, options.games);
+    std::vector<GameResult> results(options.games);
+    auto start = std::chrono::steady_clock::now();
+    runParallel(options.games, threadCount, [&](uint32_t i) {
+        results[i] = playGame(params, options.run, options.seed + i);
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    OutcomeStats stats;
+    double simulatedSeconds = 0;
+    std::vector<uint32_t> floodTimes, overflowTimes, lossTimes, winTimes;
+    for (const GameResult& result : results) {
+        stats.add(result);
+        simulatedSeconds += result.durationMs / 1000.0;
+        if (!result.finished) continue;
+        if (result.outcome == GameState::WIN) {
+            winTimes.push_back(result.durationMs);
+        } else {
+            (result.outcome == GameState::FLOOD ? floodTimes : overflowTimes).push_back(result.durationMs);
+            lossTimes.push_back(result.durationMs);
+        }
+    }
+
+    printf("policy %s, %u games, seed 0x%08X, %u threads\n", policyName(options.run.policy), options.games,
+           options.seed, threadCount);
+    printf("WIN             %6u  %5.1f%%\n", stats.wins, 100.0 * stats.winRate());
+    printf("FLOOD           %6u  %5.1f%%\n", stats.floods, 100.0 * stats.rate(stats.floods));
+    printf("BASIN_OVERFLOW  %6u  %5.1f%%\n", stats.overflows, 100.0 * stats.rate(stats.overflows));
+    printf("timeout (%us)  %6u  %5.1f%%\n", options.run.maxSeconds, stats.timeouts,
+           100.0 * stats.rate(stats.timeouts));
+    printDistribution("time to win", winTimes);
+    printDistribution("time to FLOOD", floodTimes);
+    printDistribution("time to OVERFLOW", overflowTimes);
+    printf("time to loss:\n");
+    printHistogram(lossTimes);
+    printf("%.0f games/s, %.0fx real time (%.2f s wall)\n", options.games / seconds, simulatedSeconds / seconds,
+           seconds);
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        fprintf(stderr, "Usage: %s [--games N] [--policy idle|random|gieps|greedy] [--threads T] "
+                        "[--seed S] [--max-seconds M]\n"
+                        "       %s --sweep name=min:max[:steps] ... [--random N] [--target low:high] "
+                        "[--top K] [--cache FILE] [--config FILE] [--output FILE]\n", argv[0], argv[0]);
+        return 1;
+    }
+    return options.sweep ? runSweep(options.sweepOptions) : runBatch(options);
+}
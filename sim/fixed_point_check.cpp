@@ -0,0 +1,221 @@
+// Checks the fixed-point water levels (-DHYDROLOGY_FIXED_POINT) against the
+// float model: both builds play the same seeded GameLogic games, and the level
+// trajectories and state sequences must agree within the tolerances below.
+// WaterLevel is a compile-time choice, so one build records and the other
+// compares.
+//
+// Build both:
+//   g++ -std=gnu++17 -O2 -pthread -Isim/host -Isrc -DLOG_LEVEL_MAX=LOG_LEVEL_NONE
+//       sim/fixed_point_check.cpp sim/GameRunner.cpp
+//       src/Scene.cpp src/RainSystem.cpp src/MatrixConfig.cpp src/DebugLogger.cpp
+//       src/SimClock.cpp src/GameLogic.cpp src/SecondaryLEDHandler.cpp src/InputTrace.cpp -o fixed_point_check
+//   (again with -DHYDROLOGY_FIXED_POINT -o fixed_point_check_q24)
+//
+// Run:
+//   ./fixed_point_check record levels.txt [--games N] [--seed S]
+//   ./fixed_point_check_q24 compare levels.txt
+//
+// Every policy plays N games (default 16) from seeds S, S+1, ... The record
+// holds the state and both levels after every update. compare replays the same
+// games and fails when a level differs by more than LEVEL_TOLERANCE at any
+// update, when the games go through different states, or when a state is
+// entered more than TRANSITION_TOLERANCE_UPDATES updates apart.
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "GameRunner.h"
+
+namespace {
+
+// Q8.24 rounds each per-step rate to 6e-8; over a ten-minute game that stays
+// well below what drawWaterLevel can show (1/25 of the range per row).
+constexpr float LEVEL_TOLERANCE = 1e-4f;
+// A level within rounding of a threshold may cross it one update apart.
+constexpr uint32_t TRANSITION_TOLERANCE_UPDATES = 1;
+
+constexpr Policy POLICIES[] = {Policy::IDLE, Policy::RANDOM, Policy::GIEPS, Policy::GREEDY};
+constexpr uint32_t MAX_SECONDS = 600;
+
+#ifdef HYDROLOGY_FIXED_POINT
+constexpr const char* MODEL = "fixed";
+#else
+constexpr const char* MODEL = "float";
+#endif
+
+struct Sample {
+    uint32_t update;
+    int state;
+    float sewer;
+    float basin;
+};
+
+struct Session {
+    Policy policy;
+    uint32_t seed;
+    std::vector<Sample> samples;
+};
+
+struct Transition {
+    uint32_t update;
+    int state;
+};
+
+std::vector<Session> playSessions(uint32_t games, uint32_t seed) {
+    std::vector<Session> sessions;
+    for (Policy policy : POLICIES) {
+        for (uint32_t i = 0; i < games; i++) {
+            Session session{policy, seed + i, {}};
+            uint32_t update = 0;
+            playGame(GameParams::defaults(), RunConfig{policy, MAX_SECONDS}, session.seed, nullptr,
+                     [&](const GameLogic& game) {
+                         session.samples.push_back(Sample{update++, static_cast<int>(game.getState()),
+                                                          toFloat(game.getSewerLevel()),
+                                                          toFloat(game.getBasinLevel())});
+                     });
+            sessions.push_back(std::move(session));
+        }
+    }
+    return sessions;
+}
+
+bool writeRecord(const char* path, uint32_t games, uint32_t seed, const std::vector<Session>& sessions) {
+    FILE* out = fopen(path, "w");
+    if (!out) return false;
+    fprintf(out, "model %s games %u seed %u\n", MODEL, games, seed);
+    for (const Session& session : sessions) {
+        fprintf(out, "session %s %u %zu\n", policyName(session.policy), session.seed, session.samples.size());
+        for (const Sample& sample : session.samples) {
+            fprintf(out, "%u %d %.9g %.9g\n", sample.update, sample.state, sample.sewer, sample.basin);
+        }
+    }
+    return fclose(out) == 0;
+}
+
+bool readRecord(const char* path, char* model, uint32_t& games, uint32_t& seed, std::vector<Session>& sessions) {
+    FILE* in = fopen(path, "r");
+    if (!in) return false;
+    bool ok = fscanf(in, "model %15s games %u seed %u", model, &games, &seed) == 3;
+    char name[16];
+    unsigned seedValue;
+    size_t count;
+    while (ok && fscanf(in, " session %15s %u %zu", name, &seedValue, &count) == 3) {
+        Session session{Policy::IDLE, seedValue, std::vector<Sample>(count)};
+        ok = parsePolicy(name, session.policy);
+        for (Sample& sample : session.samples) {
+            ok = ok && fscanf(in, "%u %d %f %f", &sample.update, &sample.state, &sample.sewer, &sample.basin) == 4;
+        }
+        sessions.push_back(std::move(session));
+    }
+    ok = ok && feof(in);
+    fclose(in);
+    return ok;
+}
+
+std::vector<Transition> transitions(const Session& session) {
+    std::vector<Transition> result;
+    for (const Sample& sample : session.samples) {
+        if (result.empty() || result.back().state != sample.state) {
+            result.push_back(Transition{sample.update, sample.state});
+        }
+    }
+    return result;
+}
+
+// Returns false and says why when the sessions disagree beyond the tolerances.
+bool compareSession(const Session& expected, const Session& actual, float& maxLevelDiff, uint32_t& shifted) {
+    const char* policy = policyName(expected.policy);
+    std::vector<Transition> want = transitions(expected);
+    std::vector<Transition> got = transitions(actual);
+    if (want.size() != got.size()) {
+        printf("FAIL %s seed %u: %zu states recorded, %zu replayed\n", policy, expected.seed, want.size(), got.size());
+        return false;
+    }
+    for (size_t i = 0; i < want.size(); i++) {
+        uint32_t apart = want[i].update > got[i].update ? want[i].update - got[i].update : got[i].update - want[i].update;
+        if (want[i].state != got[i].state || apart > TRANSITION_TOLERANCE_UPDATES) {
+            printf("FAIL %s seed %u: state %d at update %u recorded, state %d at update %u replayed\n", policy,
+                   expected.seed, want[i].state, want[i].update, got[i].state, got[i].update);
+            return false;
+        }
+        shifted += apart ? 1 : 0;
+    }
+
+    size_t common = std::min(expected.samples.size(), actual.samples.size());
+    for (size_t i = 0; i < common; i++) {
+        const Sample& a = expected.samples[i];
+        const Sample& b = actual.samples[i];
+        float diff = std::max(std::fabs(a.sewer - b.sewer), std::fabs(a.basin - b.basin));
+        maxLevelDiff = std::max(maxLevelDiff, diff);
+        if (diff > LEVEL_TOLERANCE) {
+            printf("FAIL %s seed %u: update %u sewer %.6f/%.6f basin %.6f/%.6f\n", policy, expected.seed, a.update,
+                   a.sewer, b.sewer, a.basin, b.basin);
+            return false;
+        }
+    }
+    return true;
+}
+
+int record(const char* path, uint32_t games, uint32_t seed) {
+    std::vector<Session> sessions = playSessions(games, seed);
+    if (!writeRecord(path, games, seed, sessions)) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return 1;
+    }
+    printf("Recorded %zu %s sessions to %s\n", sessions.size(), MODEL, path);
+    return 0;
+}
+
+int compare(const char* path) {
+    char model[16];
+    uint32_t games, seed;
+    std::vector<Session> expected;
+    if (!readRecord(path, model, games, seed, expected)) {
+        fprintf(stderr, "Cannot read %s\n", path);
+        return 1;
+    }
+    if (!strcmp(model, MODEL)) {
+        fprintf(stderr, "%s was recorded by a %s build too; compare it from the other one\n", path, model);
+        return 1;
+    }
+
+    std::vector<Session> actual = playSessions(games, seed);
+    if (actual.size() != expected.size()) {
+        fprintf(stderr, "%s holds %zu sessions, expected %zu\n", path, expected.size(), actual.size());
+        return 1;
+    }
+    uint32_t failed = 0;
+    uint32_t shifted = 0;
+    float maxLevelDiff = 0.0f;
+    for (size_t i = 0; i < expected.size(); i++) {
+        failed += compareSession(expected[i], actual[i], maxLevelDiff, shifted) ? 0 : 1;
+    }
+    printf("%s vs %s: %zu sessions, %u failed, largest level difference %.2e (tolerance %.0e), "
+           "%u transitions one update apart\n",
+           model, MODEL, expected.size(), failed, maxLevelDiff, LEVEL_TOLERANCE, shifted);
+    return failed ? 1 : 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc >= 3 && !strcmp(argv[1], "record")) {
+        uint32_t games = 16;
+        uint32_t seed = 1;
+        for (int i = 3; i + 1 < argc; i += 2) {
+            if (!strcmp(argv[i], "--games")) games = strtoul(argv[i + 1], nullptr, 0);
+            else if (!strcmp(argv[i], "--seed")) seed = strtoul(argv[i + 1], nullptr, 0);
+        }
+        return record(argv[2], games, seed);
+    }
+    if (argc == 3 && !strcmp(argv[1], "compare")) {
+        return compare(argv[2]);
+    }
+    fprintf(stderr, "usage: %s record levels.txt [--games N] [--seed S]\n"
+                    "       %s compare levels.txt\n", argv[0], argv[0]);
+    return 2;
+}
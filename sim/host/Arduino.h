@@ -0,0 +1,65 @@
+#pragma once
+// Host stand-in for the parts of the Arduino core the game code uses, so that
+// GameLogic and Scene build natively for the batch simulator. Nothing here
+// touches hardware.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+using std::max;
+using std::min;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT_PULLUP 2
+#define OUTPUT 1
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// Added to millis(), so a host run can stamp its log records like a device
+// that has been up for a while.
+inline unsigned long hostMillisOffset = 0;
+
+inline unsigned long millis() {
+    using namespace std::chrono;
+    static const auto start = steady_clock::now();
+    return hostMillisOffset + static_cast<unsigned long>(duration_cast<milliseconds>(steady_clock::now() - start).count());
+}
+
+inline unsigned long micros() {
+    using namespace std::chrono;
+    static const auto start = steady_clock::now();
+    return static_cast<unsigned long>(duration_cast<microseconds>(steady_clock::now() - start).count());
+}
+
+inline long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return HIGH; }
+inline void digitalWrite(uint8_t, uint8_t) {}
+
+// Writes to stdout. As on Arduino, print() goes through the virtual write(),
+// so a host program can redirect or count the output with a subclass.
+class Stream {
+public:
+    virtual ~Stream() {}
+    virtual size_t write(const uint8_t* buffer, size_t size) { return fwrite(buffer, 1, size, stdout); }
+    virtual size_t write(uint8_t byte) { return write(&byte, 1); }
+    size_t print(const char* text) { return write(reinterpret_cast<const uint8_t*>(text), strlen(text)); }
+    size_t println(const char* text) { return print(text) + print("\n"); }
+    void flush() { fflush(stdout); }
+    explicit operator bool() const { return true; }
+};
+
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long) {}
+};
+
+inline HardwareSerial Serial;
@@ -0,0 +1,96 @@
+#pragma once
+// Host stand-in for FastLED: colour maths only, controllers discard output.
+#include <Arduino.h>
+
+struct CRGB {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+
+    enum HTMLColorCode : uint32_t {
+        Black = 0x000000,
+        White = 0xFFFFFF,
+        Yellow = 0xFFFF00,
+        Blue = 0x0000FF,
+        Red = 0xFF0000,
+        Cyan = 0x00FFFF,
+        Green = 0x008000
+    };
+
+    CRGB() : r(0), g(0), b(0) {}
+    CRGB(uint8_t red, uint8_t green, uint8_t blue) : r(red), g(green), b(blue) {}
+    CRGB(uint32_t colorcode) : r((colorcode >> 16) & 0xFF), g((colorcode >> 8) & 0xFF), b(colorcode & 0xFF) {}
+    CRGB(HTMLColorCode colorcode) : CRGB(static_cast<uint32_t>(colorcode)) {}
+
+    bool operator==(const CRGB& other) const { return r == other.r && g == other.g && b == other.b; }
+    bool operator!=(const CRGB& other) const { return !(*this == other); }
+};
+
+// blend8 and sin8 follow FastLED 3.7.0's lib8tion (FASTLED_BLEND_FIXED and
+// sin8_C) exactly, so host frames match what the device draws.
+inline uint8_t blend8(uint8_t a, uint8_t b, uint8_t amountOfB) {
+    uint16_t partial = (a << 8) | b;  // A*256 + B
+    partial += (b * amountOfB);
+    partial -= (a * amountOfB);
+    return static_cast<uint8_t>(partial >> 8);
+}
+
+inline CRGB blend(const CRGB& a, const CRGB& b, uint8_t amountOfB) {
+    return CRGB(blend8(a.r, b.r, amountOfB), blend8(a.g, b.g, amountOfB), blend8(a.b, b.b, amountOfB));
+}
+
+inline uint8_t sin8(uint8_t theta) {
+    static const uint8_t b_m16_interleave[] = {0, 49, 49, 41, 90, 27, 117, 10};
+
+    uint8_t offset = theta;
+    if (theta & 0x40) {
+        offset = static_cast<uint8_t>(255) - offset;
+    }
+    offset &= 0x3F;  // 0..63
+
+    uint8_t secoffset = offset & 0x0F;  // 0..15
+    if (theta & 0x40) ++secoffset;
+
+    uint8_t section = offset >> 4;  // 0..3
+    uint8_t s2 = section * 2;
+    const uint8_t* p = b_m16_interleave;
+    p += s2;
+    uint8_t b = *p;
+    ++p;
+    uint8_t m16 = *p;
+
+    uint8_t mx = (m16 * secoffset) >> 4;
+
+    int8_t y = mx + b;
+    if (theta & 0x80) y = -y;
+
+    y += 128;
+
+    return y;
+}
+
+enum EOrder { RGB, GRB };
+enum LEDColorCorrection { TypicalLEDStrip };
+template <uint8_t DATA_PIN> struct WS2813 {};
+
+class CLEDController {
+public:
+    CLEDController& setCorrection(LEDColorCorrection) { return *this; }
+    void showLeds(uint8_t = 255) {}
+};
+
+class CFastLED {
+public:
+    template <template <uint8_t> class CHIPSET, uint8_t DATA_PIN, EOrder RGB_ORDER>
+    CLEDController& addLeds(CRGB*, int) { return controller; }
+    void show() {}
+    void clear(bool = false) {}
+    void setBrightness(uint8_t scale) { brightness = scale; }
+    uint8_t getBrightness() { return brightness; }
+
+private:
+    CLEDController controller;
+    uint8_t brightness = 255;
+};
+
+inline CFastLED FastLED;
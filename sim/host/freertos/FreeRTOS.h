@@ -0,0 +1,12 @@
+#pragma once
+// Host stand-in: no scheduler, tasks are never started.
+#include <cstdint>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef void* TaskHandle_t;
+
+#define pdPASS 1
+#define pdFAIL 0
+#define pdMS_TO_TICKS(ms) (ms)
@@ -0,0 +1,10 @@
+#pragma once
+#include "FreeRTOS.h"
+
+inline TickType_t xTaskGetTickCount() { return 0; }
+inline void vTaskDelay(TickType_t) {}
+inline void vTaskDelayUntil(TickType_t*, TickType_t) {}
+inline BaseType_t xTaskCreate(void (*)(void*), const char*, uint32_t, void*, UBaseType_t, TaskHandle_t*) { return pdFAIL; }
+inline BaseType_t xTaskCreatePinnedToCore(void (*)(void*), const char*, uint32_t, void*, UBaseType_t, TaskHandle_t*, int) {
+    return pdFAIL;
+}
@@ -0,0 +1,198 @@
+// Checks the SIMD hydrology kernel (sim/HydrologyBatch) against GameLogic and
+// measures its throughput in game-ticks per second.
+//
+// Build (add -mavx2 for the 8-wide path, -DHYDROLOGY_FIXED_POINT for Q8.24):
+//   g++ -std=gnu++17 -O2 -pthread -Isim/host -Isrc -DLOG_LEVEL_MAX=LOG_LEVEL_NONE
+//       sim/hydrology_bench.cpp sim/HydrologyBatch.cpp
+//       src/Scene.cpp src/RainSystem.cpp src/MatrixConfig.cpp src/DebugLogger.cpp
+//       src/SimClock.cpp src/GameLogic.cpp src/SecondaryLEDHandler.cpp src/InputTrace.cpp -o hydrology_bench
+//
+// Run:
+//   ./hydrology_bench [games] [ticks]
+//
+// Verification plays 64 real GameLogic games with random GIEP and gate
+// presses, one fixed step per update and the rain impact quantum set to zero
+// so the levels come from the per-step model alone. After every update each
+// still running game is stepped once in the kernel, from the same weather,
+// buttons and previous levels, and both kernel paths must reproduce the
+// GameLogic levels exactly.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "HydrologyBatch.h"
+
+namespace {
+
+constexpr uint8_t GATE_BUTTON = 8;
+constexpr uint32_t VERIFY_TICKS = 20000;  // About 11 minutes of play per game
+
+bool isActiveWeather(GameState state) {
+    return state == GameState::RAINING || state == GameState::HEAVY || state == GameState::STORM;
+}
+
+bool sameBits(WaterLevel a, WaterLevel b) {
+    return memcmp(&a, &b, sizeof(WaterLevel)) == 0;
+}
+
+// One GameLogic game and the buttons its random player holds.
+struct ReferenceGame {
+    SimClock clock;
+    XorShiftRandom rainRandom;
+    XorShiftRandom playerRandom;
+    MainMatrixConfig matrixConfig;
+    Scene scene;
+    SecondaryLEDHandler secondaryLEDs;
+    GameLogic game;
+    uint8_t giepMask = 0;
+    bool gateOpen = false;
+    bool running = true;
+
+    ReferenceGame(const GameParams& params, uint32_t seed)
+        : rainRandom(seed), playerRandom(seed ^ 0x5A5A5A5Au), scene(matrixConfig, clock, rainRandom),
+          secondaryLEDs(clock), game(scene, secondaryLEDs, clock, params) {}
+
+    void press(uint8_t button, bool pressed) {
+        if (button == GATE_BUTTON) {
+            gateOpen = pressed;
+        } else {
+            giepMask = pressed ? giepMask | (1 << button) : giepMask & ~(1 << button);
+        }
+        game.handleButton(button, pressed);
+    }
+
+    // Keeps most GIEPs held so games reach STORM, and works the gate.
+    void act() {
+        if (playerRandom.next8() < 16) {
+            uint8_t button = playerRandom.next8(GATE_BUTTON + 1);
+            bool held = button == GATE_BUTTON ? gateOpen : (giepMask >> button) & 1;
+            press(button, button == GATE_BUTTON ? !held : playerRandom.next8() < 224);
+        }
+    }
+};
+
+bool verify(uint32_t games) {
+    GameParams params = GameParams::defaults();
+    params.rainImpactQuantum = 0.0f;
+
+    std::vector<std::unique_ptr<ReferenceGame>> reference;
+    for (uint32_t g = 0; g < games; g++) {
+        reference.emplace_back(new ReferenceGame(params, GameConfig::Simulation::RANDOM_SEED + g));
+        ReferenceGame& game = *reference.back();
+        game.clock.setManual(0);
+        game.scene.loadDefaultScene();
+        game.game.initializeGameState();
+        game.press(g % GATE_BUTTON, true);  // Starts the game
+    }
+
+    HydrologyBatch vector(params, games);
+    HydrologyBatch scalar(params, games);
+    uint64_t compared = 0;
+    uint64_t comparedStorm = 0;
+    uint64_t comparedGateOpen = 0;
+    double updateSeconds = 0;
+    uint64_t updates = 0;
+    for (uint32_t tick = 0; tick < VERIFY_TICKS; tick++) {
+        for (uint32_t g = 0; g < games; g++) {
+            ReferenceGame& game = *reference[g];
+            if (!game.running) continue;
+            game.act();
+            // Levels and buttons as the update's step will see them
+            for (HydrologyBatch* batch : {&vector, &scalar}) {
+                batch->setLevels(g, game.game.getSewerLevel(), game.game.getBasinLevel());
+                batch->setGIEPMask(g, game.giepMask);
+                batch->setGateOpen(g, game.gateOpen);
+            }
+            game.clock.advance(GameConfig::Simulation::STEP_MS);
+            auto start = std::chrono::steady_clock::now();
+            game.game.update();
+            updateSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            updates++;
+            // Weather changes before the step; an update that ends the game
+            // changes the levels afterwards, so it is not compared.
+            if (!isActiveWeather(game.game.getState())) {
+                game.running = false;
+                continue;
+            }
+            vector.setWeather(g, game.game.getState());
+            scalar.setWeather(g, game.game.getState());
+        }
+        vector.step();
+        scalar.stepScalar();
+        for (uint32_t g = 0; g < games; g++) {
+            ReferenceGame& game = *reference[g];
+            if (!game.running) continue;
+            WaterLevel sewer = game.game.getSewerLevel();
+            WaterLevel basin = game.game.getBasinLevel();
+            if (!sameBits(vector.getSewerLevel(g), sewer) || !sameBits(vector.getBasinLevel(g), basin) ||
+                !sameBits(scalar.getSewerLevel(g), sewer) || !sameBits(scalar.getBasinLevel(g), basin)) {
+                printf("MISMATCH game %u tick %u: GameLogic %.9g/%.9g, %s %.9g/%.9g, scalar %.9g/%.9g\n", g, tick,
+                       toFloat(sewer), toFloat(basin), HydrologyBatch::vectorPath(),
+                       toFloat(vector.getSewerLevel(g)), toFloat(vector.getBasinLevel(g)),
+                       toFloat(scalar.getSewerLevel(g)), toFloat(scalar.getBasinLevel(g)));
+                return false;
+            }
+            compared++;
+            comparedStorm += game.game.getState() == GameState::STORM;
+            comparedGateOpen += game.gateOpen;
+        }
+    }
+
+    uint32_t ended = 0;
+    for (const auto& game : reference) ended += !game->running;
+    printf("verify: %llu steps over %u games (%u ended, %llu steps in STORM, %llu with the gate open) "
+           "bit-identical to GameLogic\n", static_cast<unsigned long long>(compared), games, ended,
+           static_cast<unsigned long long>(comparedStorm), static_cast<unsigned long long>(comparedGateOpen));
+    printf("GameLogic::update for scale: %.2f M game-ticks/s\n", updates / updateSeconds / 1e6);
+    return true;
+}
+
+// Fills the batch with a spread of weathers, buttons and levels that keeps the
+// gate and clamp branches busy.
+void seedBatch(HydrologyBatch& batch) {
+    XorShiftRandom random(GameConfig::Simulation::RANDOM_SEED);
+    const GameState weathers[] = {GameState::RAINING, GameState::HEAVY, GameState::STORM, GameState::WAITING_DRY};
+    for (uint32_t g = 0; g < batch.size(); g++) {
+        batch.setWeather(g, weathers[random.next8(4)]);
+        batch.setGIEPMask(g, random.next8());
+        batch.setGateOpen(g, random.next8() < 128);
+        batch.setLevels(g, WaterLevel(random.next8() / 255.0f), WaterLevel(random.next8() / 512.0f));
+    }
+}
+
+template <typename Step>
+double ticksPerSecond(HydrologyBatch& batch, uint32_t ticks, Step step) {
+    seedBatch(batch);
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t t = 0; t < ticks; t++) step();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(batch.size()) * ticks / seconds;
+}
+
+void bench(uint32_t games, uint32_t ticks) {
+    HydrologyBatch batch(GameParams::defaults(), games);
+    double scalar = ticksPerSecond(batch, ticks, [&] { batch.stepScalar(); });
+    double vector = ticksPerSecond(batch, ticks, [&] { batch.step(); });
+
+    printf("%u games x %u ticks\n", games, ticks);
+    printf("  %-8s %8.1f M game-ticks/s\n", "scalar", scalar / 1e6);
+    if (strcmp(HydrologyBatch::vectorPath(), "scalar")) {
+        printf("  %-8s %8.1f M game-ticks/s  (%.1fx scalar)\n", HydrologyBatch::vectorPath(), vector / 1e6,
+               vector / scalar);
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    uint32_t games = argc > 1 ? strtoul(argv[1], nullptr, 0) : 4096;
+    uint32_t ticks = argc > 2 ? strtoul(argv[2], nullptr, 0) : 20000;
+    if (!verify(64)) return 1;
+    bench(games, ticks);
+    return 0;
+}
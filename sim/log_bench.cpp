@@ -0,0 +1,220 @@
+// Measures what logging costs: plays seeded headless games with DebugLogger
+// on, counts the bytes it writes, and compares them with the 115200 baud
+// budget. Build it once as text and once with -DLOG_TOKENIZED=1 to compare the
+// two modes on the same games. With --calls it times single log calls instead.
+//
+// Build:
+//   g++ -std=gnu++17 -O2 -pthread -Isim/host -Isrc -DLOG_LEVEL_MAX=LOG_LEVEL_DEBUG [-DLOG_TOKENIZED=1]
+//       sim/log_bench.cpp sim/GameRunner.cpp
+//       src/Scene.cpp src/RainSystem.cpp src/MatrixConfig.cpp src/DebugLogger.cpp
+//       src/SimClock.cpp src/GameLogic.cpp src/SecondaryLEDHandler.cpp src/InputTrace.cpp -o log_bench
+//
+// Run:
+//   ./log_bench [--games N] [--level info|game_state|debug] [--policy P] [--seed S] [--dump]
+//   ./log_bench --calls N
+//
+// With --dump the log itself goes to stdout (feed a tokenized one to
+// tools/log_decoder) and the summary to stderr. Records are stamped as if the
+// device had been up for ten minutes, so text timestamps have their usual width.
+//
+// --calls times the per-step "Water levels updated" call, in bursts of half
+// the ring with the ring drained between bursts, three ways: the blocking
+// logger this one replaced (vsnprintf and println on the caller), the
+// deferred enqueue the caller now pays, and enqueue plus drain together, the
+// total CPU cost. Output goes nowhere, so the blocking figure leaves out the
+// wait on the serial port that made it a problem.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "DebugLogger.h"
+#include "GameRunner.h"
+
+namespace {
+
+constexpr uint32_t SERIAL_BYTES_PER_SECOND = 115200 / 10;  // 8N1
+constexpr unsigned long DEVICE_UPTIME_MS = 10UL * 60 * 1000;
+
+struct LevelName {
+    LogLevel level;
+    const char* name;
+};
+
+constexpr LevelName LEVEL_NAMES[] = {
+    {LogLevel::INFO, "info"},
+    {LogLevel::GAME_STATE, "game_state"},
+    {LogLevel::DEBUG, "debug"},
+};
+
+// Counts what the logger writes and passes it on only when dumping.
+class CountingStream : public Stream {
+public:
+    explicit CountingStream(bool forward) : forward(forward) {}
+
+    size_t write(const uint8_t* buffer, size_t size) override {
+        bytes += size;
+        records += LOG_TOKENIZED ? 1 : std::count(buffer, buffer + size, '\n');
+        return forward ? fwrite(buffer, 1, size, stdout) : size;
+    }
+
+    uint64_t bytes = 0;
+    uint64_t records = 0;
+
+private:
+    bool forward;
+};
+
+// DebugLogger before deferral: formats and prints on the calling task.
+class BlockingLogger {
+public:
+    explicit BlockingLogger(Stream& stream) : stream(stream) {}
+
+    void gameState(const char* format, ...) {
+        va_list args;
+        va_start(args, format);
+        char buffer[256];
+        int prefixLen = snprintf(buffer, sizeof(buffer), "%lu [%s] ", millis(), "GAME_STATE");
+        vsnprintf(buffer + prefixLen, sizeof(buffer) - prefixLen, format, args);
+        stream.println(buffer);
+        va_end(args);
+    }
+
+private:
+    Stream& stream;
+};
+
+// Times `calls` calls of log(i) in bursts, running between() untimed after
+// each burst. Returns nanoseconds per call.
+template <typename Log, typename Between>
+double timeCalls(uint32_t calls, Log log, Between between) {
+    constexpr uint32_t BURST = DebugLogger::QUEUE_SIZE / 2;
+    std::chrono::steady_clock::duration total{};
+    for (uint32_t done = 0; done < calls; done += BURST) {
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < BURST; i++) {
+            log(done + i);
+        }
+        total += std::chrono::steady_clock::now() - start;
+        between();
+    }
+    uint32_t timed = (calls + BURST - 1) / BURST * BURST;
+    return std::chrono::duration<double, std::nano>(total).count() / timed;
+}
+
+void benchCalls(uint32_t calls) {
+    CountingStream stream(false);
+    DebugLogger::init(stream, LogLevel::GAME_STATE);
+    BlockingLogger blocking(stream);
+    // Varying arguments, as the levels do from step to step.
+    auto level = [](uint32_t i) { return static_cast<float>(i % 1000) / 1000.0f; };
+
+    double blockingNs = timeCalls(
+        calls,
+        [&](uint32_t i) {
+            blocking.gameState("Water levels updated - State: %s, Sewer: %.2f, Basin: %.2f, Increase Rate: %.3f, GIEP: %.3f",
+                               "HEAVY", level(i), level(i + 7), level(i) * 0.02f, level(i + 3) * 0.02f);
+        },
+        [] {});
+    auto deferred = [&](uint32_t i) {
+        LOG_GAME_STATE("Water levels updated - State: %s, Sewer: %.2f, Basin: %.2f, Increase Rate: %.3f, GIEP: %.3f",
+                       "HEAVY", level(i), level(i + 7), level(i) * 0.02f, level(i + 3) * 0.02f);
+    };
+    DebugLogger::setHoldUntilFlush(true);
+    double enqueueNs = timeCalls(calls, deferred, [] { DebugLogger::flush(); });
+    DebugLogger::setHoldUntilFlush(false);
+    double totalNs = timeCalls(calls, deferred, [] {});
+
+    printf("mode          %s\n", LOG_TOKENIZED ? "tokenized" : "text");
+    printf("calls         %u, bursts of %u\n", calls, DebugLogger::QUEUE_SIZE / 2);
+    printf("blocking      %7.1f ns/call on the caller\n", blockingNs);
+    printf("enqueue       %7.1f ns/call on the caller (%.1fx less)\n", enqueueNs, blockingNs / enqueueNs);
+    printf("enqueue+drain %7.1f ns/call in total\n", totalNs);
+    printf("dropped       %u\n", DebugLogger::getDroppedCount());
+}
+
+struct Options {
+    uint32_t calls = 0;
+    uint32_t games = 20;
+    LogLevel level = LogLevel::GAME_STATE;
+    RunConfig run = {Policy::RANDOM, 600};
+    uint32_t seed = 1;
+    bool dump = false;
+};
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const char* flag = argv[i];
+        if (!strcmp(flag, "--dump")) {
+            options.dump = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const char* value = argv[++i];
+        if (!strcmp(flag, "--calls")) {
+            options.calls = strtoul(value, nullptr, 0);
+        } else if (!strcmp(flag, "--games")) {
+            options.games = strtoul(value, nullptr, 0);
+        } else if (!strcmp(flag, "--seed")) {
+            options.seed = strtoul(value, nullptr, 0);
+        } else if (!strcmp(flag, "--policy")) {
+            if (!parsePolicy(value, options.run.policy)) return false;
+        } else if (!strcmp(flag, "--level")) {
+            const LevelName* match = nullptr;
+            for (const LevelName& entry : LEVEL_NAMES) {
+                if (!strcmp(value, entry.name)) match = &entry;
+            }
+            if (!match) return false;
+            options.level = match->level;
+        } else {
+            return false;
+        }
+    }
+    return options.games > 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        fprintf(stderr, "usage: %s [--games N] [--level info|game_state|debug] [--policy P] [--seed S] [--dump]\n"
+                        "       %s --calls N\n", argv[0], argv[0]);
+        return 2;
+    }
+    if (options.calls) {
+        benchCalls(options.calls);
+        return 0;
+    }
+
+    hostMillisOffset = DEVICE_UPTIME_MS;
+    CountingStream stream(options.dump);
+    DebugLogger::init(stream, options.level);
+
+    // The logger drains inline on the host, so the games run on this thread only.
+    uint64_t gameMs = 0;
+    for (uint32_t i = 0; i < options.games; i++) {
+        gameMs += playGame(GameParams::defaults(), options.run, options.seed + i).durationMs;
+    }
+    DebugLogger::flush();
+
+    FILE* out = options.dump ? stderr : stdout;
+    double seconds = gameMs / 1000.0;
+    double bytesPerSecond = stream.bytes / seconds;
+    fprintf(out, "mode          %s\n", LOG_TOKENIZED ? "tokenized" : "text");
+    fprintf(out, "games         %u (%s), %.0f s of play\n", options.games, policyName(options.run.policy), seconds);
+    fprintf(out, "records       %llu, %.1f per second\n", static_cast<unsigned long long>(stream.records),
+            stream.records / seconds);
+    fprintf(out, "bytes         %llu, %.1f per record\n", static_cast<unsigned long long>(stream.bytes),
+            stream.records ? static_cast<double>(stream.bytes) / stream.records : 0.0);
+    fprintf(out, "serial load   %.0f B/s, %.1f%% of 115200 baud\n", bytesPerSecond,
+            100.0 * bytesPerSecond / SERIAL_BYTES_PER_SECOND);
+    fprintf(out, "dropped       %u\n", DebugLogger::getDroppedCount());
+    return 0;
+}
@@ -0,0 +1,165 @@
+// Measures the per-frame cost of mapping matrix pixels to LED indices, before
+// and after MatrixConfig became a compile-time table. "runtime" is the old
+// MatrixConfig::XY, kept here as a reference: an orientation switch, a bounds
+// check and two debug log calls per pixel, with logging off as on the device.
+//
+// Build:
+//   g++ -std=gnu++17 -O2 -Isim/host -Isrc sim/matrix_bench.cpp src/MatrixConfig.cpp src/DebugLogger.cpp -o matrix_bench
+//
+// Run:
+//   ./matrix_bench [frames]
+//
+// First checks that the tables give the same LED for every pixel as the old
+// mapping, for every orientation with and without zigzag. A frame is then one
+// pass over all 625 pixels of the device layout, which is what Scene::draw
+// mapped every frame before the background cache; the level, river and rain
+// loops mapped more on top.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "config.h"
+
+namespace {
+
+// The mapping as it was before the lookup tables.
+class RuntimeMatrixConfig {
+public:
+    RuntimeMatrixConfig(uint8_t width, uint8_t height, MatrixOrientation orientation, bool zigzag)
+        : width(width), height(height), orientation(orientation), zigzag(zigzag) {}
+
+    uint16_t XY(uint8_t x, uint8_t y) const {
+        DebugLogger::debug("XY input: x=%u, y=%u", static_cast<unsigned int>(x), static_cast<unsigned int>(y));
+
+        if (x >= width || y >= height) {
+            DebugLogger::error("Invalid coordinates: (%u, %u)", static_cast<unsigned int>(x),
+                               static_cast<unsigned int>(y));
+            return 0;
+        }
+
+        uint16_t i = 0;
+        switch (orientation) {
+            case MatrixOrientation::TOP_LEFT_HORIZONTAL:
+                if (zigzag && y % 2 == 1) x = (width - 1) - x;
+                i = (y * width) + x;
+                break;
+            case MatrixOrientation::TOP_LEFT_VERTICAL:
+                if (zigzag && x % 2 == 1) y = (height - 1) - y;
+                i = (x * height) + y;
+                break;
+            case MatrixOrientation::BOTTOM_LEFT_HORIZONTAL:
+                y = (height - 1) - y;
+                if (zigzag && y % 2 == 1) x = (width - 1) - x;
+                i = (y * width) + x;
+                break;
+            case MatrixOrientation::BOTTOM_LEFT_VERTICAL:
+                x = (width - 1) - x;
+                if (zigzag && x % 2 == 0) y = (height - 1) - y;
+                i = (x * height) + y;
+                break;
+            case MatrixOrientation::BOTTOM_RIGHT_VERTICAL:
+                y = (height - 1) - y;
+                if (zigzag && x % 2 == 1) y = (height - 1) - y;
+                i = (x * height) + y;
+                break;
+        }
+        DebugLogger::debug("XY mapping result: (%u, %u) -> %u", static_cast<unsigned int>(x),
+                           static_cast<unsigned int>(y), i);
+        return i;
+    }
+
+private:
+    uint8_t width;
+    uint8_t height;
+    MatrixOrientation orientation;
+    bool zigzag;
+};
+
+template <uint8_t W, uint8_t H, MatrixOrientation Orientation, bool Zigzag>
+bool checkLayout() {
+    using Layout = MatrixConfig<W, H, Orientation, Zigzag>;
+    RuntimeMatrixConfig runtime(W, H, Orientation, Zigzag);
+    for (uint8_t y = 0; y < H; y++) {
+        for (uint8_t x = 0; x < W; x++) {
+            uint16_t index = Layout::XYUnchecked(x, y);
+            MatrixCoord coord = Layout::coordOf(index);
+            if (index != runtime.XY(x, y) || coord.x != x || coord.y != y) {
+                printf("MISMATCH %ux%u %s%s at (%u, %u)\n", W, H, orientationToString(Orientation),
+                       Zigzag ? " zigzag" : "", x, y);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <uint8_t W, uint8_t H, MatrixOrientation Orientation>
+bool checkOrientation() {
+    return checkLayout<W, H, Orientation, false>() && checkLayout<W, H, Orientation, true>();
+}
+
+template <uint8_t W, uint8_t H>
+bool checkSize() {
+    return checkOrientation<W, H, MatrixOrientation::TOP_LEFT_HORIZONTAL>() &&
+           checkOrientation<W, H, MatrixOrientation::TOP_LEFT_VERTICAL>() &&
+           checkOrientation<W, H, MatrixOrientation::BOTTOM_LEFT_HORIZONTAL>() &&
+           checkOrientation<W, H, MatrixOrientation::BOTTOM_LEFT_VERTICAL>() &&
+           checkOrientation<W, H, MatrixOrientation::BOTTOM_RIGHT_VERTICAL>();
+}
+
+// Times `frames` full passes and returns nanoseconds per pass.
+template <typename Map>
+double timeFrames(uint32_t frames, Map map, uint32_t& sink) {
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t f = 0; f < frames; f++) {
+        for (uint8_t y = 0; y < MATRIX_HEIGHT; y++) {
+            for (uint8_t x = 0; x < MATRIX_WIDTH; x++) {
+                sink += map(x, y);
+            }
+        }
+        // Keeps the passes from being merged or hoisted out of the loop.
+        asm volatile("" : "+r"(sink));
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return seconds * 1e9 / frames;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    uint32_t frames = argc > 1 ? strtoul(argv[1], nullptr, 0) : 200000;
+    if (frames == 0) {
+        fprintf(stderr, "usage: %s [frames]\n", argv[0]);
+        return 2;
+    }
+
+    if (!checkSize<MATRIX_WIDTH, MATRIX_HEIGHT>() || !checkSize<8, 5>() || !checkSize<1, 7>()) {
+        return 1;
+    }
+    printf("verify: tables match the runtime mapping for every orientation, 25x25, 8x5 and 1x7\n");
+
+    // Opaque to the optimizer, as the old config was a runtime object.
+    volatile MatrixOrientation orientation = MATRIX_ORIENTATION;
+    const RuntimeMatrixConfig runtime(MATRIX_WIDTH, MATRIX_HEIGHT, orientation, MATRIX_ZIGZAG);
+    const MainMatrixConfig tables;
+
+    uint32_t sink = 0;
+    struct Result {
+        const char* name;
+        double ns;
+    } results[] = {
+        {"runtime XY", timeFrames(frames, [&](uint8_t x, uint8_t y) { return runtime.XY(x, y); }, sink)},
+        {"table XY", timeFrames(frames, [&](uint8_t x, uint8_t y) { return tables.XY(x, y); }, sink)},
+        {"XYUnchecked", timeFrames(frames, [&](uint8_t x, uint8_t y) { return tables.XYUnchecked(x, y); }, sink)},
+    };
+
+    const uint32_t pixels = MATRIX_WIDTH * MATRIX_HEIGHT;
+    printf("%u frames of %u mappings (checksum %u)\n", frames, pixels, sink);
+    for (const Result& result : results) {
+        printf("  %-12s %8.0f ns/frame  %5.2f ns/pixel  (%.1fx runtime)\n", result.name, result.ns,
+               result.ns / pixels, results[0].ns / result.ns);
+    }
+    return 0;
+}
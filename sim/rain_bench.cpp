@@ -0,0 +1,115 @@
+// Times RainSystem at a given number of live drops: one update() step, the
+// capture() into the render snapshot, and draw() of that frame.
+//
+// Build (add -DSURFACE_WATER_GRID to include the runoff branch):
+//   g++ -std=gnu++17 -O2 -Isim/host -Isrc -DLOG_LEVEL_MAX=LOG_LEVEL_NONE
+//       sim/rain_bench.cpp src/RainSystem.cpp src/MatrixConfig.cpp src/DebugLogger.cpp -o rain_bench
+//
+// Run:
+//   ./rain_bench [steps]
+//
+// The rain falls on a matrix with no surfaces, so every drop crosses all 25
+// rows, and the intensity is set to hold the live count near the target. The
+// last target is the pool size, the most drops the spawn spacing allows: every
+// column then spawns as often as it may, and the live count cycles up to the
+// full pool. "peak" is the most drops seen after one step.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "RainSystem.h"
+
+namespace {
+
+constexpr uint16_t TARGETS[] = {10, 100, RainFrame::MAX_DROPS};
+constexpr uint32_t WARMUP_STEPS = 200;
+
+struct Timing {
+    double liveDrops = 0;
+    uint16_t peakDrops = 0;
+    double updateNs = 0;
+    double captureNs = 0;
+    double drawNs = 0;
+};
+
+double nanosSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Spawn chance per eligible column that holds `target` drops: a drop lives
+// MATRIX_HEIGHT steps, and a column spawns every SPACING + 1 / chance steps.
+float spawnChance(uint16_t target) {
+    float interval = static_cast<float>(MATRIX_WIDTH) * MATRIX_HEIGHT / target;
+    float wait = interval - GameConfig::RainVisuals::RAIN_MIN_DROP_SPACING;
+    return wait > 1.0f ? 1.0f / wait : 1.0f;
+}
+
+Timing timeRain(const MainMatrixConfig& matrixConfig, RainMode mode, uint16_t target, uint32_t steps, uint32_t& sink) {
+    XorShiftRandom rng(GameConfig::Simulation::RANDOM_SEED);
+    RainSystem rain(matrixConfig, rng);
+    rain.setMode(mode);
+    rain.setIntensity(spawnChance(target) / (mode == RainMode::STORM ? GameConfig::RainVisuals::RAIN_STORM_MULTIPLIER : 1.0f));
+    static RainFrame frame;
+    static CRGB leds[NUM_LEDS];
+
+    Timing timing;
+    for (uint32_t step = 0; step < WARMUP_STEPS + steps; step++) {
+        bool timed = step >= WARMUP_STEPS;
+
+        auto start = std::chrono::steady_clock::now();
+        rain.update();
+        double updateNs = nanosSince(start);
+
+        start = std::chrono::steady_clock::now();
+        rain.capture(frame);
+        double captureNs = nanosSince(start);
+
+        start = std::chrono::steady_clock::now();
+        rain.draw(frame, leds);
+        double drawNs = nanosSince(start);
+        sink += leds[step % NUM_LEDS].b;
+
+        if (timed) {
+            timing.liveDrops += frame.count;
+            timing.peakDrops = std::max(timing.peakDrops, frame.count);
+            timing.updateNs += updateNs;
+            timing.captureNs += captureNs;
+            timing.drawNs += drawNs;
+        }
+    }
+    timing.liveDrops /= steps;
+    timing.updateNs /= steps;
+    timing.captureNs /= steps;
+    timing.drawNs /= steps;
+    return timing;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    uint32_t steps = argc > 1 ? strtoul(argv[1], nullptr, 0) : 100000;
+    if (steps == 0) {
+        fprintf(stderr, "usage: %s [steps]\n", argv[0]);
+        return 2;
+    }
+
+    MainMatrixConfig matrixConfig;
+    uint32_t sink = 0;
+    printf("%u steps per run, pool of %u drops\n", steps, RainFrame::MAX_DROPS);
+    printf("  %-6s %6s %8s %6s %10s %10s %10s %12s\n", "mode", "target", "live", "peak", "update ns", "capture ns",
+           "draw ns", "ns per drop");
+    const RainMode modes[] = {RainMode::NORMAL, RainMode::STORM};
+    for (RainMode mode : modes) {
+        for (uint16_t target : TARGETS) {
+            Timing t = timeRain(matrixConfig, mode, target, steps, sink);
+            printf("  %-6s %6u %8.1f %6u %10.0f %10.0f %10.0f %12.1f\n", mode == RainMode::STORM ? "storm" : "normal",
+                   target, t.liveDrops, t.peakDrops, t.updateNs, t.captureNs, t.drawNs,
+                   (t.updateNs + t.captureNs + t.drawNs) / t.liveDrops);
+        }
+    }
+    printf("(checksum %u)\n", sink);
+    return 0;
+}
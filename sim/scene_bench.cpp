@@ -0,0 +1,175 @@
+// Measures the share of LED frame time that Scene's background cache saves.
+// Plays games with a random player on a manual clock and, after every game
+// tick, times the LED task's frame: Scene::update() and Scene::draw(). The
+// frame starts from a copy of the cached background; the bench also times the
+// per-pixel pass it replaced (pixel type lookup and colour switch for all 625
+// pixels, kept here as a reference) and the copy itself. The pass is timed on
+// today's bitplane map and on a byte-per-pixel map, as the tree had then.
+//
+// Build (add -DSURFACE_WATER_GRID to include the water layer):
+//   g++ -std=gnu++17 -O2 -pthread -Isim/host -Isrc -DLOG_LEVEL_MAX=LOG_LEVEL_NONE
+//       sim/scene_bench.cpp
+//       src/Scene.cpp src/RainSystem.cpp src/MatrixConfig.cpp src/DebugLogger.cpp
+//       src/SimClock.cpp src/GameLogic.cpp src/SecondaryLEDHandler.cpp src/InputTrace.cpp -o scene_bench
+//
+// Run:
+//   ./scene_bench [frames]
+//
+// The uncached frame is estimated as the cached frame minus the copy plus the
+// per-pixel pass, since both fill the same background before the dynamic
+// layers are drawn.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "GameLogic.h"
+#include "config.h"
+
+namespace {
+
+using namespace GameConfig;
+
+constexpr uint8_t GATE_BUTTON = 8;
+constexpr uint32_t DECISION_INTERVAL_MS = 250;
+
+// Scene::draw's background before the cache, with the colours of
+// Scene::getColorForPixelType. `Map` is the scene's bitplanes, or a byte per
+// pixel as the map was stored when the cache went in.
+template <typename Map>
+void drawBackgroundPerPixel(const MainMatrixConfig& matrixConfig, const Map& typeAt, uint8_t giepMask,
+                            bool gateActive, CRGB* leds) {
+    for (uint8_t y = 0; y < MATRIX_HEIGHT; y++) {
+        for (uint8_t x = 0; x < MATRIX_WIDTH; x++) {
+            PixelType type = typeAt(y * MATRIX_WIDTH + x);
+            CRGB color = CRGB::Black;
+            switch (type) {
+                case PixelType::ACTIVE:
+                    color = CRGB(Brightness::ACTIVE_BRIGHTNESS, Brightness::ACTIVE_BRIGHTNESS, Brightness::ACTIVE_BRIGHTNESS);
+                    break;
+                case PixelType::GIEP_1:
+                case PixelType::GIEP_2:
+                case PixelType::GIEP_3:
+                case PixelType::GIEP_4:
+                case PixelType::GIEP_5:
+                case PixelType::GIEP_6:
+                case PixelType::GIEP_7:
+                case PixelType::GIEP_8: {
+                    int index = static_cast<int>(type) - static_cast<int>(PixelType::GIEP_1);
+                    color = (giepMask >> index) & 1 ? CRGB(0, Brightness::GIEP_ACTIVE_BRIGHTNESS, 0)
+                                                    : CRGB(0, Brightness::GIEP_INACTIVE_BRIGHTNESS, 0);
+                    break;
+                }
+                case PixelType::BASIN_GATE:
+                    color = gateActive ? CRGB(Brightness::BASIN_GATE_BRIGHTNESS, 0, 0)
+                                       : CRGB(Brightness::BASIN_GATE_INACTIVE_BRIGHTNESS, 0, 0);
+                    break;
+                default:
+                    break;
+            }
+            leds[matrixConfig.XYUnchecked(x, y)] = color;
+        }
+    }
+}
+
+double nanosSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    uint32_t frames = argc > 1 ? strtoul(argv[1], nullptr, 0) : 20000;
+    if (frames == 0) {
+        fprintf(stderr, "usage: %s [frames]\n", argv[0]);
+        return 2;
+    }
+
+    SimClock clock;
+    clock.setManual(0);
+    XorShiftRandom rainRandom(Simulation::RANDOM_SEED);
+    XorShiftRandom playerRandom(Simulation::RANDOM_SEED ^ 0x5A5A5A5Au);
+    MainMatrixConfig matrixConfig;
+    Scene scene(matrixConfig, clock, rainRandom);
+    scene.loadDefaultScene();
+    SecondaryLEDHandler secondaryLEDs(clock);
+    GameLogic game(scene, secondaryLEDs, clock, GameParams::defaults());
+    game.initializeGameState();
+
+    const SceneBitboard& pixelMap = scene.getPixelMap();
+    PixelType byteMap[NUM_LEDS];
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+        byteMap[i] = pixelMap.typeAt(i);
+    }
+    auto planeTypeAt = [&](uint16_t i) { return pixelMap.typeAt(i); };
+    auto byteTypeAt = [&](uint16_t i) { return byteMap[i]; };
+
+    static CRGB leds[NUM_LEDS];
+    static CRGB reference[NUM_LEDS];
+    uint8_t giepMask = 0;
+    bool gateOpen = false;
+    uint32_t games = 0;
+    uint32_t checksum = 0;
+    double frameNs = 0;
+    double planePassNs = 0;
+    double bytePassNs = 0;
+    double copyNs = 0;
+
+    uint32_t sinceDecision = DECISION_INTERVAL_MS;
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        GameState state = game.getState();
+        bool playing = state == GameState::RAINING || state == GameState::HEAVY || state == GameState::STORM;
+        if (sinceDecision >= DECISION_INTERVAL_MS) {
+            sinceDecision = 0;
+            // Starts the next game, then toggles a random button now and then
+            if (!playing || playerRandom.next8() < 64) {
+                uint8_t button = playing ? playerRandom.next8(GATE_BUTTON + 1) : 0;
+                bool held = button == GATE_BUTTON ? gateOpen : (giepMask >> button) & 1;
+                if (button == GATE_BUTTON) gateOpen = !held;
+                else giepMask = held ? giepMask & ~(1 << button) : giepMask | (1 << button);
+                game.handleButton(button, !held);
+            }
+        }
+        clock.advance(TaskConfig::GAME_UPDATE_INTERVAL_MS);
+        sinceDecision += TaskConfig::GAME_UPDATE_INTERVAL_MS;
+        game.update();
+        games += !playing && game.getState() == GameState::RAINING ? 1 : 0;
+
+        auto start = std::chrono::steady_clock::now();
+        scene.update();
+        scene.draw(leds);
+        frameNs += nanosSince(start);
+        scene.markClean();
+
+        start = std::chrono::steady_clock::now();
+        drawBackgroundPerPixel(matrixConfig, planeTypeAt, giepMask, gateOpen, reference);
+        planePassNs += nanosSince(start);
+
+        start = std::chrono::steady_clock::now();
+        drawBackgroundPerPixel(matrixConfig, byteTypeAt, giepMask, gateOpen, reference);
+        bytePassNs += nanosSince(start);
+
+        start = std::chrono::steady_clock::now();
+        memcpy(reference, leds, sizeof(leds));
+        copyNs += nanosSince(start);
+        checksum += reference[frame % NUM_LEDS].b;
+    }
+
+    frameNs /= frames;
+    copyNs /= frames;
+    printf("%u frames over %u games (checksum %u)\n", frames, games, checksum);
+    printf("  frame, cached      %8.0f ns  (update + draw)\n", frameNs);
+    printf("  background copy    %8.0f ns\n", copyNs);
+    struct Pass {
+        const char* map;
+        double ns;
+    } passes[] = {{"bitplane map", planePassNs / frames}, {"byte map", bytePassNs / frames}};
+    for (const Pass& pass : passes) {
+        double uncachedNs = frameNs - copyNs + pass.ns;
+        printf("  %-12s       per-pixel pass %6.0f ns, uncached frame %6.0f ns, cache saves %4.1f%%\n", pass.map,
+               pass.ns, uncachedNs, 100.0 * (uncachedNs - frameNs) / uncachedNs);
+    }
+    return 0;
+}
@@ -0,0 +1,166 @@
+// Two-thread stress test for SeqLock. A writer thread publishes numbered
+// payloads as fast as it can while a reader thread takes snapshots and checks
+// each one: every word must come from the same write, and the number must
+// never go backwards. One payload is the size of the scene's RenderState; a
+// 7-byte one covers the part-word copy at the end.
+//
+// Build (add -fsanitize=thread -g -Wno-tsan to run it under ThreadSanitizer,
+// which warns that it does not model SeqLock's fences):
+//   g++ -std=gnu++17 -O2 -pthread -Isim/host -Isrc sim/seqlock_stress.cpp -o seqlock_stress
+//
+// Run:
+//   ./seqlock_stress [writes]
+//
+// Exits 1 if any snapshot was torn or older than the one before it. "Repeats"
+// are snapshots taken before the next write landed, "skipped" are writes the
+// reader never saw; both are expected and only show how the threads overlapped.
+// On a single core the threads only overlap when one is preempted mid-copy;
+// with two or more they overlap far more often.
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "Scene.h"
+#include "SeqLock.h"
+
+namespace {
+
+// Word i of write n is n mixed with i, so a copy mixing two writes shows.
+uint32_t wordFor(uint32_t n, uint32_t i) {
+    return (n * 0x9E3779B1u) ^ (i * 0x85EBCA77u);
+}
+
+struct LargePayload {
+    static constexpr size_t WORDS = sizeof(RenderState) / sizeof(uint32_t) - 1;
+
+    uint32_t sequence;
+    uint32_t words[WORDS];
+
+    void fill(uint32_t n) {
+        sequence = n;
+        for (uint32_t i = 0; i < WORDS; i++) words[i] = wordFor(n, i);
+    }
+
+    bool consistent() const {
+        for (uint32_t i = 0; i < WORDS; i++) {
+            if (words[i] != wordFor(sequence, i)) return false;
+        }
+        return true;
+    }
+};
+
+// 7 bytes: a 24-bit sequence and four check bytes, so the last word is partial.
+struct SmallPayload {
+    uint8_t bytes[7];
+
+    void fill(uint32_t n) {
+        bytes[0] = n & 0xFF;
+        bytes[1] = (n >> 8) & 0xFF;
+        bytes[2] = (n >> 16) & 0xFF;
+        uint32_t check = wordFor(n & 0xFFFFFF, 0);
+        for (int i = 0; i < 4; i++) bytes[3 + i] = (check >> (8 * i)) & 0xFF;
+    }
+
+    uint32_t number() const {
+        return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16);
+    }
+
+    bool consistent() const {
+        SmallPayload expected;
+        expected.fill(number());
+        for (int i = 3; i < 7; i++) {
+            if (bytes[i] != expected.bytes[i]) return false;
+        }
+        return true;
+    }
+};
+
+uint32_t numberOf(const LargePayload& payload) {
+    return payload.sequence;
+}
+
+uint32_t numberOf(const SmallPayload& payload) {
+    return payload.number();
+}
+
+struct Result {
+    uint64_t reads = 0;
+    uint64_t torn = 0;
+    uint64_t backwards = 0;
+    uint64_t repeats = 0;
+    uint32_t seen = 0;  // Distinct writes observed
+    bool sawLast = false;
+};
+
+template <typename Payload>
+Result stress(uint32_t writes) {
+    Payload initial;
+    initial.fill(0);
+    SeqLock<Payload> lock(initial);
+    std::atomic<bool> done(false);
+
+    std::thread writer([&] {
+        Payload payload;
+        for (uint32_t n = 1; n <= writes; n++) {
+            payload.fill(n);
+            lock.write(payload);
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    Result result;
+    uint32_t last = 0;
+    for (;;) {
+        // Read the flag first, so the snapshot after it is the final write.
+        bool finished = done.load(std::memory_order_acquire);
+        Payload snapshot;
+        lock.read(snapshot);
+        result.reads++;
+        uint32_t n = numberOf(snapshot);
+        if (!snapshot.consistent()) {
+            if (result.torn++ == 0) printf("  torn snapshot at read %llu\n", static_cast<unsigned long long>(result.reads));
+        } else if (n < last) {
+            if (result.backwards++ == 0) printf("  write %u read after write %u\n", n, last);
+        } else if (n == last) {
+            result.repeats++;
+        } else {
+            result.seen++;
+            last = n;
+        }
+        if (finished) break;
+    }
+    writer.join();
+    result.sawLast = last == writes;
+    if (!result.sawLast) printf("  last snapshot was write %u of %u\n", last, writes);
+    return result;
+}
+
+template <typename Payload>
+bool report(const char* name, uint32_t writes) {
+    Result r = stress<Payload>(writes);
+    printf("  %-7s %4zu B %12llu %8llu %10llu %12llu %12u\n", name, sizeof(Payload),
+           static_cast<unsigned long long>(r.reads), static_cast<unsigned long long>(r.torn + r.backwards),
+           static_cast<unsigned long long>(r.repeats), static_cast<unsigned long long>(writes - r.seen), r.seen);
+    return r.torn == 0 && r.backwards == 0 && r.sawLast;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    uint32_t writes = argc > 1 ? strtoul(argv[1], nullptr, 0) : 2000000;
+    // The small payload numbers its writes in 24 bits.
+    if (writes == 0 || writes > 0xFFFFFF) {
+        fprintf(stderr, "usage: %s [writes]  (1 to %u)\n", argv[0], 0xFFFFFFu);
+        return 2;
+    }
+
+    printf("%u writes per payload, %u hardware threads\n", writes, std::thread::hardware_concurrency());
+    printf("  %-7s %6s %12s %8s %10s %12s %12s\n", "payload", "size", "reads", "bad", "repeats", "skipped", "seen");
+    bool ok = report<LargePayload>("large", writes);
+    ok = report<SmallPayload>("small", writes) && ok;
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+// Two-thread stress test for SpscQueue. A producer thread pushes numbered
+// QueuedInput items, retrying while the queue is full, and a consumer thread
+// pops them and checks that every number arrives once and in order, with the
+// rest of the item intact. It runs at the game's input queue capacity and at
+// the smallest and a large one.
+//
+// Build (add -fsanitize=thread -g to run it under ThreadSanitizer):
+//   g++ -std=gnu++17 -O2 -pthread -Isim/host -Isrc sim/spsc_stress.cpp -o spsc_stress
+//
+// Run:
+//   ./spsc_stress [items]
+//
+// Exits 1 on a lost, repeated, reordered or damaged item. "Full" and "empty"
+// count the failed push and pop calls spun through while waiting.
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "GameLogic.h"
+#include "SpscQueue.h"
+
+namespace {
+
+// Every field follows from the number, so a slot read mid-write shows.
+QueuedInput itemFor(uint32_t n) {
+    return QueuedInput{n, static_cast<InputSource>(n % 2), static_cast<uint8_t>(n * 7), (n & 4) != 0};
+}
+
+bool sameItem(const QueuedInput& a, const QueuedInput& b) {
+    return a.timeMs == b.timeMs && a.source == b.source && a.index == b.index && a.pressed == b.pressed;
+}
+
+struct Result {
+    uint64_t fullSpins = 0;
+    uint64_t emptySpins = 0;
+    uint32_t received = 0;
+    uint32_t bad = 0;
+};
+
+template <size_t CAPACITY>
+Result stress(uint32_t items) {
+    SpscQueue<QueuedInput, CAPACITY> queue;
+    Result result;
+    uint64_t fullSpins = 0;
+
+    std::thread producer([&] {
+        for (uint32_t n = 0; n < items; n++) {
+            QueuedInput item = itemFor(n);
+            while (!queue.push(item)) {
+                fullSpins++;
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t expected = 0;
+    while (expected < items) {
+        QueuedInput item;
+        if (!queue.pop(item)) {
+            result.emptySpins++;
+            std::this_thread::yield();
+            continue;
+        }
+        if (!sameItem(item, itemFor(expected))) {
+            if (result.bad++ == 0) printf("  expected item %u, got item %u\n", expected, item.timeMs);
+            // Resynchronise on what arrived, so one fault is not counted again for every item after it.
+            expected = item.timeMs;
+        }
+        result.received++;
+        expected++;
+    }
+    producer.join();
+
+    QueuedInput extra;
+    if (queue.pop(extra)) {
+        printf("  item %u left over after the last one\n", extra.timeMs);
+        result.bad++;
+    }
+    result.fullSpins = fullSpins;
+    return result;
+}
+
+template <size_t CAPACITY>
+bool report(uint32_t items) {
+    Result r = stress<CAPACITY>(items);
+    printf("  %8zu %12u %12llu %12llu %8u\n", CAPACITY, r.received, static_cast<unsigned long long>(r.fullSpins),
+           static_cast<unsigned long long>(r.emptySpins), r.bad);
+    return r.bad == 0 && r.received == items;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    uint32_t items = argc > 1 ? strtoul(argv[1], nullptr, 0) : 2000000;
+    if (items == 0) {
+        fprintf(stderr, "usage: %s [items]\n", argv[0]);
+        return 2;
+    }
+
+    printf("%u items per capacity, %u hardware threads\n", items, std::thread::hardware_concurrency());
+    printf("  %8s %12s %12s %12s %8s\n", "capacity", "received", "full", "empty", "bad");
+    bool ok = report<1>(items);
+    ok = report<GameConfig::Diagnostics::INPUT_QUEUE_CAPACITY>(items) && ok;
+    ok = report<1024>(items) && ok;
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,325 @@
+// Records, extracts and replays input traces (src/InputTrace.h), hashing every
+// rendered frame so that gameplay and rendering regressions show up as the
+// first frame whose hash changed.
+//
+// Build:
+//   g++ -std=gnu++17 -O2 -pthread -Isim/host -Isrc -DLOG_LEVEL_MAX=LOG_LEVEL_NONE
+//       sim/trace_replay.cpp sim/GameRunner.cpp
+//       src/Scene.cpp src/RainSystem.cpp src/MatrixConfig.cpp src/DebugLogger.cpp
+//       src/SimClock.cpp src/GameLogic.cpp src/SecondaryLEDHandler.cpp src/InputTrace.cpp -o trace_replay
+//
+// Pull the trace out of a serial capture taken while the debug button was pressed:
+//   ./trace_replay extract capture.log round.trace
+// Record a trace from a simulated player instead:
+//   ./trace_replay record round.trace [--policy random] [--seed S] [--max-seconds M]
+// Replay it, as fast as possible or paced at the recorded tick:
+//   ./trace_replay play round.trace [--realtime] [--frames N] [--hashes out.txt] [--expect good.txt]
+//
+// Replays run the batch simulator's loop: manual clock, rain generator in the
+// state the trace header recorded, one GameLogic and Scene update per tick.
+// A trace begins at the press that started its game, and starting a game
+// resets the rain and the step clock, so nothing from before the trace
+// matters. Replays are deterministic on the host. A device trace replays the
+// same inputs at the same frames, but at the fixed recorded tick rather than
+// the device's jittered one, so its round is close rather than identical.
+// A trace whose ring wrapped has lost its first inputs and replays a
+// different round; play warns about it.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "GameRunner.h"
+#include "config.h"
+
+namespace {
+
+constexpr uint32_t DEFAULT_TAIL_MS = 60000;  // Played after the last input, enough to reach the end state
+
+struct Trace {
+    InputTraceHeader header;
+    std::vector<InputEvent> events;
+};
+
+bool readFile(const char* path, std::vector<uint8_t>& data) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return true;
+}
+
+bool writeFile(const char* path, const std::vector<uint8_t>& data) {
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(data.data()), data.size());
+    return static_cast<bool>(out);
+}
+
+std::vector<uint8_t> encodeTrace(const InputTraceHeader& header, const InputTrace& trace) {
+    std::vector<uint8_t> data(InputTrace::HEADER_SIZE + trace.size() * InputTrace::EVENT_SIZE);
+    InputTrace::encodeHeader(data.data(), header);
+    for (uint16_t i = 0; i < trace.size(); i++) {
+        InputTrace::encodeEvent(&data[InputTrace::HEADER_SIZE + i * InputTrace::EVENT_SIZE], trace.at(i));
+    }
+    return data;
+}
+
+bool decodeTrace(const std::vector<uint8_t>& data, Trace& trace) {
+    if (data.size() < InputTrace::HEADER_SIZE || !InputTrace::decodeHeader(data.data(), trace.header)) {
+        return false;
+    }
+    if (data.size() != InputTrace::HEADER_SIZE + trace.header.eventCount * InputTrace::EVENT_SIZE) {
+        return false;
+    }
+    for (uint32_t i = 0; i < trace.header.eventCount; i++) {
+        trace.events.push_back(InputTrace::decodeEvent(&data[InputTrace::HEADER_SIZE + i * InputTrace::EVENT_SIZE]));
+    }
+    return true;
+}
+
+int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// Keeps the last complete TRACE BEGIN ... TRACE END block of the capture.
+int runExtract(const char* capturePath, const char* outputPath) {
+    std::ifstream in(capturePath);
+    if (!in) {
+        fprintf(stderr, "Cannot read %s\n", capturePath);
+        return 1;
+    }
+    std::vector<uint8_t> block;
+    std::vector<uint8_t> complete;
+    bool inBlock = false;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        size_t at = line.find("TRACE ");
+        if (at == std::string::npos) continue;
+        std::string body = line.substr(at + 6);
+        if (body.compare(0, 5, "BEGIN") == 0) {
+            block.clear();
+            inBlock = true;
+        } else if (body == "END") {
+            if (inBlock) complete = block;
+            inBlock = false;
+        } else if (inBlock) {
+            for (size_t i = 0; i + 1 < body.size(); i += 2) {
+                int high = hexDigit(body[i]);
+                int low = hexDigit(body[i + 1]);
+                if (high < 0 || low < 0) {
+                    inBlock = false;  // Garbled line, drop the block
+                    break;
+                }
+                block.push_back(static_cast<uint8_t>(high << 4 | low));
+            }
+        }
+    }
+    Trace trace;
+    if (!decodeTrace(complete, trace)) {
+        fprintf(stderr, "No complete trace in %s\n", capturePath);
+        return 1;
+    }
+    if (!writeFile(outputPath, complete)) {
+        fprintf(stderr, "Cannot write %s\n", outputPath);
+        return 1;
+    }
+    printf("%u inputs (%u dropped), rain state 0x%08X, tick %u ms, from frame %u -> %s\n", trace.header.eventCount,
+           trace.header.droppedCount, trace.header.rainState, trace.header.tickMs, trace.header.startFrame, outputPath);
+    return 0;
+}
+
+int runRecord(const char* outputPath, int argc, char** argv) {
+    RunConfig config = {Policy::RANDOM, 600};
+    uint32_t seed = GameConfig::Simulation::RANDOM_SEED;
+    for (int i = 0; i + 1 < argc; i += 2) {
+        bool ok = true;
+        if (!strcmp(argv[i], "--policy")) {
+            ok = parsePolicy(argv[i + 1], config.policy);
+        } else if (!strcmp(argv[i], "--seed")) {
+            seed = strtoul(argv[i + 1], nullptr, 0);
+        } else if (!strcmp(argv[i], "--max-seconds")) {
+            config.maxSeconds = strtoul(argv[i + 1], nullptr, 0);
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            fprintf(stderr, "Bad option: %s %s\n", argv[i], argv[i + 1]);
+            return 1;
+        }
+    }
+
+    InputTrace trace;
+    GameResult result = playGame(GameParams::defaults(), config, seed, &trace);
+    InputTraceHeader header = trace.header(static_cast<uint16_t>(SIM_TICK_MS));
+    if (!writeFile(outputPath, encodeTrace(header, trace))) {
+        fprintf(stderr, "Cannot write %s\n", outputPath);
+        return 1;
+    }
+    printf("policy %s, seed 0x%08X: %u inputs, game ended %s after %u frames -> %s\n", policyName(config.policy),
+           seed, trace.size(), result.finished ? "in an end state" : "by the time limit",
+           result.durationMs / SIM_TICK_MS, outputPath);
+    return 0;
+}
+
+uint32_t hashFrame(const CRGB* leds) {
+    uint32_t hash = 2166136261u;  // FNV-1a
+    for (uint32_t i = 0; i < NUM_LEDS; i++) {
+        const uint8_t bytes[3] = {leds[i].r, leds[i].g, leds[i].b};
+        for (uint8_t b : bytes) hash = (hash ^ b) * 16777619u;
+    }
+    return hash;
+}
+
+bool readHashes(const char* path, std::vector<uint32_t>& hashes) {
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+    uint32_t frame;
+    uint32_t hash;
+    while (fscanf(file, "%u %x", &frame, &hash) == 2) hashes.push_back(hash);
+    fclose(file);
+    return true;
+}
+
+int runPlay(const char* tracePath, int argc, char** argv) {
+    bool realtime = false;
+    uint32_t frames = 0;
+    const char* hashesPath = nullptr;
+    const char* expectPath = nullptr;
+    for (int i = 0; i < argc; i++) {
+        if (!strcmp(argv[i], "--realtime")) {
+            realtime = true;
+        } else if (i + 1 < argc && !strcmp(argv[i], "--frames")) {
+            frames = strtoul(argv[++i], nullptr, 0);
+        } else if (i + 1 < argc && !strcmp(argv[i], "--hashes")) {
+            hashesPath = argv[++i];
+        } else if (i + 1 < argc && !strcmp(argv[i], "--expect")) {
+            expectPath = argv[++i];
+        } else {
+            fprintf(stderr, "Bad option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    std::vector<uint8_t> data;
+    Trace trace;
+    if (!readFile(tracePath, data) || !decodeTrace(data, trace)) {
+        fprintf(stderr, "Cannot read a trace from %s\n", tracePath);
+        return 1;
+    }
+    const InputTraceHeader& header = trace.header;
+    if (!frames) {
+        uint32_t lastFrame = trace.events.empty() ? 0 : trace.events.back().frame - header.startFrame;
+        frames = lastFrame + 1 + DEFAULT_TAIL_MS / header.tickMs;
+    }
+    std::vector<uint32_t> expected;
+    if (expectPath && !readHashes(expectPath, expected)) {
+        fprintf(stderr, "Cannot read %s\n", expectPath);
+        return 1;
+    }
+
+    if (header.droppedCount) {
+        fprintf(stderr, "warning: the trace lost its first %u inputs when the ring wrapped; "
+                        "this is not the recorded round\n", header.droppedCount);
+    }
+
+    // Inputs go in during the update whose clock they carry, as on the device,
+    // so the clock starts one tick before the trace's first update.
+    SimClock clock;
+    clock.setManual(header.startTimeMs >= header.tickMs ? header.startTimeMs - header.tickMs : 0);
+    XorShiftRandom rainRandom(header.rainState);
+    MainMatrixConfig matrixConfig;
+    Scene scene(matrixConfig, clock, rainRandom);
+    scene.loadDefaultScene();
+    SecondaryLEDHandler secondaryLEDs(clock);
+    GameLogic game(scene, secondaryLEDs, clock, GameParams::defaults());
+    InputReplay replay(trace.events.data(), trace.events.size(), header.startFrame);
+    static CRGB leds[NUM_LEDS];
+
+    std::vector<uint32_t> hashes(frames);
+    uint32_t combined = 2166136261u;
+    uint32_t firstMismatch = UINT32_MAX;
+    bool ended = false;
+    double slowestUs = 0;
+    uint32_t slowestFrame = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        if (realtime) {
+            std::this_thread::sleep_until(start + std::chrono::milliseconds(static_cast<uint64_t>(frame) * header.tickMs));
+        }
+        auto frameStart = std::chrono::steady_clock::now();
+        replay.applyBeforeAdvance(frame, clock.now(), game);
+        clock.advance(header.tickMs);
+        replay.applyAfterAdvance(frame, game);
+        game.update();
+        scene.update();
+        if (scene.isDirty()) {
+            scene.draw(leds);
+            scene.markClean();
+        }
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - frameStart).count();
+        if (us > slowestUs) {
+            slowestUs = us;
+            slowestFrame = frame;
+        }
+
+        hashes[frame] = hashFrame(leds);
+        combined = (combined ^ hashes[frame]) * 16777619u;
+        if (firstMismatch == UINT32_MAX && frame < expected.size() && expected[frame] != hashes[frame]) {
+            firstMismatch = frame;
+        }
+        GameState state = game.getState();
+        if (!ended && (state == GameState::WIN || state == GameState::FLOOD || state == GameState::BASIN_OVERFLOW)) {
+            printf("frame %u: %s\n", frame + 1, game.getStateString());
+            ended = true;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (hashesPath) {
+        FILE* file = fopen(hashesPath, "w");
+        if (!file) {
+            fprintf(stderr, "Cannot write %s\n", hashesPath);
+            return 1;
+        }
+        for (uint32_t frame = 0; frame < frames; frame++) fprintf(file, "%u %08x\n", frame, hashes[frame]);
+        fclose(file);
+    }
+
+    printf("%u frames, %zu inputs%s, replay hash %08x\n", frames, trace.events.size(),
+           replay.isDone() ? "" : " (not all applied)", combined);
+    printf("%.0f frames/s, slowest frame %u took %.0f us\n", frames / seconds, slowestFrame, slowestUs);
+    if (expectPath) {
+        if (firstMismatch != UINT32_MAX) {
+            printf("MISMATCH: first differing frame %u\n", firstMismatch);
+            return 1;
+        }
+        if (expected.size() != frames) {
+            printf("MISMATCH: %zu expected frames, replayed %u\n", expected.size(), frames);
+            return 1;
+        }
+        printf("all %u frames match %s\n", frames, expectPath);
+    }
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc >= 4 && !strcmp(argv[1], "extract")) return runExtract(argv[2], argv[3]);
+    if (argc >= 3 && !strcmp(argv[1], "record")) return runRecord(argv[2], argc - 3, argv + 3);
+    if (argc >= 3 && !strcmp(argv[1], "play")) return runPlay(argv[2], argc - 3, argv + 3);
+    fprintf(stderr, "Usage: %s extract CAPTURE OUT.trace\n"
+                    "       %s record OUT.trace [--policy P] [--seed S] [--max-seconds M]\n"
+                    "       %s play TRACE [--realtime] [--frames N] [--hashes FILE] [--expect FILE]\n",
+            argv[0], argv[0], argv[0]);
+    return 1;
+}
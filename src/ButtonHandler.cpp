@@ -1,4 +1,6 @@
 #include "ButtonHandler.h"
+#include "FrameStats.h"
+#include "OutputScheduler.h"
 
 ButtonHandler::ButtonHandler(MCP23017Handler& mcpHandler, GameLogic& gameLogic)
     : _mcpHandler(mcpHandler), _gameLogic(gameLogic), _lastMcpStates(0xFF), _mcpButtonStates(0xFF),
@@ -10,7 +12,7 @@ ButtonHandler::ButtonHandler(MCP23017Handler& mcpHandler, GameLogic& gameLogic)
     pinMode(BASIN_GATE_LED_PIN, OUTPUT);
     pinMode(DEBUG_BUTTON_PIN, INPUT_PULLUP);
 
-    DebugLogger::info("ButtonHandler initialized. Basin Gate Button Pin: %d, LED Pin: %d", BASIN_GATE_BUTTON_PIN, BASIN_GATE_LED_PIN);
+    LOG_INFO("ButtonHandler initialized. Basin Gate Button Pin: %d, LED Pin: %d", BASIN_GATE_BUTTON_PIN, BASIN_GATE_LED_PIN);
 }
 
 void ButtonHandler::update() {
@@ -46,17 +48,17 @@ void ButtonHandler::updateMcpButtons(uint32_t now) {
 
 void ButtonHandler::updateBasinGateButton(uint32_t now) {
     int reading = digitalRead(BASIN_GATE_BUTTON_PIN);
-    DebugLogger::debug("Basin Gate Button reading: %d", reading);
+    LOG_DEBUG("Basin Gate Button reading: %d", reading);
     
     if (reading != _lastBasinGateState) {
         _lastBasinGateDebounceTime = now;
-        DebugLogger::debug("Basin Gate Button state changed. New state: %d", reading);
+        LOG_DEBUG("Basin Gate Button state changed. New state: %d", reading);
     }
     
     if ((now - _lastBasinGateDebounceTime) > DEBOUNCE_DELAY) {
         if (reading != _basinGateButtonState) {
             _basinGateButtonState = reading;
-            DebugLogger::debug("Basin Gate Button debounced. New state: %d", _basinGateButtonState);
+            LOG_DEBUG("Basin Gate Button debounced. New state: %d", _basinGateButtonState);
             
             if (_basinGateButtonState == LOW) {
                 onBasinGateButtonPressed();
@@ -85,31 +87,43 @@ void ButtonHandler::updateDebugButton(uint32_t now) {
 }
 
 void ButtonHandler::onButtonPressed(uint8_t button) {
-    DebugLogger::info("GIEP Button %d pressed", button + 1);
-    _gameLogic.handleButton(button, true);
+    LOG_INFO("GIEP Button %d pressed", button + 1);
+    queueInput(InputSource::BUTTON, button, true);
 }
 
 void ButtonHandler::onButtonReleased(uint8_t button) {
-    DebugLogger::info("GIEP Button %d released", button + 1);
-    _gameLogic.handleButton(button, false);
+    LOG_INFO("GIEP Button %d released", button + 1);
+    queueInput(InputSource::BUTTON, button, false);
 }
 
 void ButtonHandler::onBasinGateButtonPressed() {
-    DebugLogger::info("Basin Gate Button pressed");
+    LOG_INFO("Basin Gate Button pressed");
     digitalWrite(BASIN_GATE_LED_PIN, HIGH);
-    _gameLogic.handleBasinGateButton(true);
-    DebugLogger::debug("Basin Gate LED turned ON");
+    queueInput(InputSource::BASIN_GATE, 8, true);
+    LOG_DEBUG("Basin Gate LED turned ON");
 }
 
 void ButtonHandler::onBasinGateButtonReleased() {
-    DebugLogger::info("Basin Gate Button released");
+    LOG_INFO("Basin Gate Button released");
     digitalWrite(BASIN_GATE_LED_PIN, LOW);
-    _gameLogic.handleBasinGateButton(false);
-    DebugLogger::debug("Basin Gate LED turned OFF");
+    queueInput(InputSource::BASIN_GATE, 8, false);
+    LOG_DEBUG("Basin Gate LED turned OFF");
 }
 
 void ButtonHandler::onDebugButtonPressed() {
-    DebugLogger::info("Debug button pressed");
-    DebugLogger::info("Current game state: %s", _gameLogic.getStateString());
+    LOG_INFO("Debug button pressed");
+    LOG_INFO("Current game state: %s", _gameLogic.getStateString());
+    LOG_INFO("LED frames shown: %lu, skipped: %lu",
+             static_cast<unsigned long>(FrameStats::getShowCount()),
+             static_cast<unsigned long>(FrameStats::getSkippedShowCount()));
+    OutputScheduler::logStats();
+    // The trace is written by the game task, so it dumps it between ticks
+    _gameLogic.requestTraceDump();
     // Add more debug information as needed
+}
+
+void ButtonHandler::queueInput(InputSource source, uint8_t index, bool pressed) {
+    if (!_gameLogic.queueInput(source, index, pressed)) {
+        LOG_WARN("Input queue full, dropped button %d %s", index + 1, pressed ? "press" : "release");
+    }
 }
\ No newline at end of file
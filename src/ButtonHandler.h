@@ -34,4 +34,5 @@ private:
     void onBasinGateButtonPressed();
     void onBasinGateButtonReleased();
     void onDebugButtonPressed();
+    void queueInput(InputSource source, uint8_t index, bool pressed);
 };
\ No newline at end of file
@@ -1,69 +1,330 @@
 #include "DebugLogger.h"
+#include "game_config.h"
+#if defined(ARDUINO_ARCH_ESP32)
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#endif
 
 Stream* DebugLogger::s_stream = nullptr;
 LogLevel DebugLogger::s_logLevel = LogLevel::CRITICAL;
+DebugLogger::Slot DebugLogger::s_slots[DebugLogger::QUEUE_SIZE];
+std::atomic<uint32_t> DebugLogger::s_enqueuePos(0);
+uint32_t DebugLogger::s_dequeuePos = 0;
+std::atomic<bool> DebugLogger::s_draining(false);
+std::atomic<uint32_t> DebugLogger::s_dropped(0);
+uint32_t DebugLogger::s_droppedReported = 0;
+bool DebugLogger::s_drainTaskRunning = false;
+bool DebugLogger::s_holdUntilFlush = false;
 
 void DebugLogger::init(Stream& stream, LogLevel level) {
+    for (uint32_t i = 0; i < QUEUE_SIZE; i++) {
+        s_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    s_enqueuePos.store(0, std::memory_order_relaxed);
+    s_dequeuePos = 0;
     s_stream = &stream;
     s_logLevel = level;
+
+#if defined(ARDUINO_ARCH_ESP32)
+    if (!s_drainTaskRunning) {
+        BaseType_t result = xTaskCreate(drainTask, "LogDrainTask", GameConfig::TaskConfig::LOG_DRAIN_TASK_STACK_SIZE,
+                                        NULL, GameConfig::TaskConfig::LOG_DRAIN_TASK_PRIORITY, NULL);
+        s_drainTaskRunning = (result == pdPASS);
+    }
+#endif
 }
 
 void DebugLogger::setLogLevel(LogLevel level) {
     s_logLevel = level;
 }
 
-void DebugLogger::log(LogLevel level, const char* format, va_list args) {
-    if (s_stream && level <= s_logLevel) {
-        char buffer[256];
-        unsigned long timestamp = millis();
-        int prefixLen = snprintf(buffer, sizeof(buffer), "%lu [%s] ", timestamp, getLevelString(level));
-        vsnprintf(buffer + prefixLen, sizeof(buffer) - prefixLen, format, args);
-        s_stream->println(buffer);
+void DebugLogger::setHoldUntilFlush(bool hold) {
+    s_holdUntilFlush = hold;
+}
+
+uint32_t DebugLogger::getDroppedCount() {
+    return s_dropped.load(std::memory_order_relaxed);
+}
+
+void DebugLogger::enqueue(LogLevel level, LogFormat format, const LogArg* args, uint8_t argCount, uint16_t argKinds) {
+    // Bounded MPSC queue: a producer claims a slot by advancing s_enqueuePos,
+    // fills it, then publishes it through the slot's sequence number.
+    uint32_t pos = s_enqueuePos.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+        slot = &s_slots[pos & (QUEUE_SIZE - 1)];
+        uint32_t seq = slot->sequence.load(std::memory_order_acquire);
+        int32_t diff = static_cast<int32_t>(seq - pos);
+        if (diff == 0) {
+            if (s_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            s_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            pos = s_enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    LogRecord& record = slot->record;
+    record.timestamp = millis();
+    record.level = level;
+    record.format = format;
+    record.argCount = argCount;
+    record.argKinds = argKinds;
+    for (uint8_t i = 0; i < argCount; i++) {
+        record.args[i] = args[i];
+    }
+    slot->sequence.store(pos + 1, std::memory_order_release);
+
+    if (!s_drainTaskRunning && !s_holdUntilFlush) {
+        drain();
     }
 }
 
-void DebugLogger::critical(const char* format, ...) {
-    va_list args;
-    va_start(args, format);
-    log(LogLevel::CRITICAL, format, args);
-    va_end(args);
+bool DebugLogger::drain() {
+    // Only one consumer at a time: the drain task or a flushing caller.
+    if (s_draining.exchange(true, std::memory_order_acquire)) {
+        return false;
+    }
+
+    for (;;) {
+        Slot& slot = s_slots[s_dequeuePos & (QUEUE_SIZE - 1)];
+        uint32_t seq = slot.sequence.load(std::memory_order_acquire);
+        if (static_cast<int32_t>(seq - (s_dequeuePos + 1)) < 0) {
+            break;
+        }
+        LogRecord record = slot.record;
+        slot.sequence.store(s_dequeuePos + QUEUE_SIZE, std::memory_order_release);
+        s_dequeuePos++;
+        writeRecord(record);
+    }
+
+    uint32_t dropped = s_dropped.load(std::memory_order_relaxed);
+    if (dropped != s_droppedReported) {
+        reportDropped(dropped - s_droppedReported);
+        s_droppedReported = dropped;
+    }
+
+    s_draining.store(false, std::memory_order_release);
+    return true;
 }
 
-void DebugLogger::error(const char* format, ...) {
-    va_list args;
-    va_start(args, format);
-    log(LogLevel::ERROR, format, args);
-    va_end(args);
+void DebugLogger::flush() {
+    while (!drain()) {
+#if defined(ARDUINO_ARCH_ESP32)
+        vTaskDelay(1);  // Let the drain task finish its batch
+#endif
+    }
 }
 
-void DebugLogger::warn(const char* format, ...) {
-    va_list args;
-    va_start(args, format);
-    log(LogLevel::WARN, format, args);
-    va_end(args);
+void DebugLogger::drainTask(void*) {
+#if defined(ARDUINO_ARCH_ESP32)
+    const TickType_t interval = pdMS_TO_TICKS(GameConfig::TaskConfig::LOG_DRAIN_INTERVAL_MS);
+    while (true) {
+        drain();
+        vTaskDelay(interval);
+    }
+#endif
 }
 
-void DebugLogger::info(const char* format, ...) {
-    va_list args;
-    va_start(args, format);
-    log(LogLevel::INFO, format, args);
-    va_end(args);
+void DebugLogger::reportDropped(uint32_t dropped) {
+    LogRecord record;
+    record.timestamp = millis();
+    record.level = LogLevel::WARN;
+    record.argCount = 1;
+    record.argKinds = static_cast<uint16_t>(LogArgKind::INTEGER);
+#if LOG_TOKENIZED
+    record.format = DROPPED_TOKEN;
+#else
+    record.format = "%lu log records dropped";
+#endif
+    record.args[0].i = dropped;
+    writeRecord(record);
 }
 
-void DebugLogger::gameState(const char* format, ...) {
-    va_list args;
-    va_start(args, format);
-    log(LogLevel::GAME_STATE, format, args);
-    va_end(args);
+#if LOG_TOKENIZED
+
+void DebugLogger::writeRecord(const LogRecord& record) {
+    if (!s_stream) {
+        return;
+    }
+    uint8_t buffer[288];
+    size_t length = encodeRecord(buffer, sizeof(buffer), record);
+    s_stream->write(buffer, length);
 }
 
-void DebugLogger::debug(const char* format, ...) {
-    va_list args;
-    va_start(args, format);
-    log(LogLevel::DEBUG, format, args);
-    va_end(args);
+static size_t putVarint(uint8_t* buffer, size_t pos, size_t size, uint64_t value) {
+    while (pos < size) {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        buffer[pos++] = value ? (byte | 0x80) : byte;
+        if (!value) {
+            break;
+        }
+    }
+    return pos;
 }
 
+// Frame layout: [sync|level] [token, 4 bytes LE] [varint timestamp] [argCount]
+// [kinds, 2 bits per argument] then each argument: zigzag varint for integers,
+// float32 LE for floats, varint length + bytes for strings, varint for pointers.
+size_t DebugLogger::encodeRecord(uint8_t* buffer, size_t size, const LogRecord& record) {
+    static constexpr size_t MAX_STRING_LENGTH = 32;
+    size_t pos = 0;
+    buffer[pos++] = FRAME_SYNC | (static_cast<uint8_t>(record.level) & 0x0F);
+    for (uint8_t i = 0; i < 4; i++) {
+        buffer[pos++] = (record.format >> (8 * i)) & 0xFF;
+    }
+    pos = putVarint(buffer, pos, size, record.timestamp);
+    buffer[pos++] = record.argCount;
+    for (uint8_t i = 0; i < record.argCount; i += 4) {
+        buffer[pos++] = (record.argKinds >> (2 * i)) & 0xFF;
+    }
+
+    for (uint8_t i = 0; i < record.argCount; i++) {
+        const LogArg& arg = record.args[i];
+        switch (static_cast<LogArgKind>((record.argKinds >> (2 * i)) & 0x03)) {
+            case LogArgKind::INTEGER: {
+                uint64_t zigzag = (static_cast<uint64_t>(arg.i) << 1) ^ static_cast<uint64_t>(arg.i >> 63);
+                pos = putVarint(buffer, pos, size, zigzag);
+                break;
+            }
+            case LogArgKind::FLOAT: {
+                float value = static_cast<float>(arg.d);
+                uint32_t bits;
+                memcpy(&bits, &value, sizeof(bits));
+                for (uint8_t b = 0; b < 4 && pos < size; b++) {
+                    buffer[pos++] = (bits >> (8 * b)) & 0xFF;
+                }
+                break;
+            }
+            case LogArgKind::STRING: {
+                const char* str = arg.p ? static_cast<const char*>(arg.p) : "(null)";
+                size_t length = strnlen(str, MAX_STRING_LENGTH);
+                pos = putVarint(buffer, pos, size, length);
+                for (size_t c = 0; c < length && pos < size; c++) {
+                    buffer[pos++] = static_cast<uint8_t>(str[c]);
+                }
+                break;
+            }
+            case LogArgKind::POINTER:
+                pos = putVarint(buffer, pos, size, reinterpret_cast<uintptr_t>(arg.p));
+                break;
+        }
+    }
+    return pos;
+}
+
+#else
+
+void DebugLogger::writeRecord(const LogRecord& record) {
+    if (!s_stream) {
+        return;
+    }
+    char buffer[256];
+    int prefixLen = snprintf(buffer, sizeof(buffer), "%lu [%s] ",
+                             static_cast<unsigned long>(record.timestamp), getLevelString(record.level));
+    formatRecord(buffer + prefixLen, sizeof(buffer) - prefixLen, record);
+    s_stream->println(buffer);
+}
+
+// printf-style formatter driven by the captured argument slots. Each
+// conversion is handed to snprintf individually with the type its spec asks for.
+size_t DebugLogger::formatRecord(char* buffer, size_t size, const LogRecord& record) {
+    size_t out = 0;
+    uint8_t argIndex = 0;
+    const char* p = record.format;
+    buffer[0] = '\0';
+
+    while (*p && out + 1 < size) {
+        if (*p != '%') {
+            buffer[out++] = *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            buffer[out++] = '%';
+            p += 2;
+            continue;
+        }
+
+        char spec[16];
+        size_t specLen = 0;
+        spec[specLen++] = *p++;
+        while (*p && strchr("-+ #0123456789.", *p) && specLen < sizeof(spec) - 4) {
+            spec[specLen++] = *p++;
+        }
+        uint8_t longCount = 0;
+        while (*p && strchr("hlzjtL", *p) && specLen < sizeof(spec) - 2) {
+            if (*p == 'l') longCount++;
+            spec[specLen++] = *p++;
+        }
+        if (!*p) {
+            break;
+        }
+        char conversion = *p++;
+        spec[specLen++] = conversion;
+        spec[specLen] = '\0';
+
+        if (argIndex >= record.argCount) {
+            int written = snprintf(buffer + out, size - out, "%s", spec);
+            out += written > 0 ? written : 0;
+            continue;
+        }
+        const LogArg& arg = record.args[argIndex++];
+
+        int written = 0;
+        switch (conversion) {
+            case 'd':
+            case 'i':
+                if (longCount >= 2) written = snprintf(buffer + out, size - out, spec, static_cast<long long>(arg.i));
+                else if (longCount == 1) written = snprintf(buffer + out, size - out, spec, static_cast<long>(arg.i));
+                else written = snprintf(buffer + out, size - out, spec, static_cast<int>(arg.i));
+                break;
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+                if (longCount >= 2) written = snprintf(buffer + out, size - out, spec, static_cast<unsigned long long>(arg.i));
+                else if (longCount == 1) written = snprintf(buffer + out, size - out, spec, static_cast<unsigned long>(arg.i));
+                else written = snprintf(buffer + out, size - out, spec, static_cast<unsigned int>(arg.i));
+                break;
+            case 'c':
+                written = snprintf(buffer + out, size - out, spec, static_cast<int>(arg.i));
+                break;
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+                written = snprintf(buffer + out, size - out, spec, arg.d);
+                break;
+            case 's':
+                written = snprintf(buffer + out, size - out, spec, arg.p ? static_cast<const char*>(arg.p) : "(null)");
+                break;
+            case 'p':
+                written = snprintf(buffer + out, size - out, spec, arg.p);
+                break;
+            default:
+                written = snprintf(buffer + out, size - out, "%s", spec);
+                break;
+        }
+        if (written > 0) {
+            out += static_cast<size_t>(written);
+        }
+    }
+
+    if (out >= size) {
+        out = size - 1;
+    }
+    buffer[out] = '\0';
+    return out;
+}
+
+#endif
+
 const char* DebugLogger::getLevelString(LogLevel level) {
     switch (level) {
         case LogLevel::CRITICAL:   return "CRITICAL";
@@ -74,4 +335,4 @@ const char* DebugLogger::getLevelString(LogLevel level) {
         case LogLevel::DEBUG:      return "DEBUG";
         default:                   return "UNKNOWN";
     }
-}
\ No newline at end of file
+}
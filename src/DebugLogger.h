@@ -1,32 +1,256 @@
 #pragma once
 #include <Arduino.h>
+#include <atomic>
+#include <type_traits>
+
+// Numeric log levels for the preprocessor; keep in sync with LogLevel.
+#define LOG_LEVEL_NONE       0
+#define LOG_LEVEL_CRITICAL   1
+#define LOG_LEVEL_ERROR      2
+#define LOG_LEVEL_WARN       3
+#define LOG_LEVEL_INFO       4
+#define LOG_LEVEL_GAME_STATE 5
+#define LOG_LEVEL_DEBUG      6
+
+// Highest level compiled into the firmware, set per env with -DLOG_LEVEL_MAX=...
+#ifndef LOG_LEVEL_MAX
+#define LOG_LEVEL_MAX LOG_LEVEL_DEBUG
+#endif
+
+// With -DLOG_TOKENIZED=1 call sites pass a 32-bit hash of their format string
+// instead of the string itself, and records go out as compact binary frames
+// decoded on the host by tools/log_decoder.
+#ifndef LOG_TOKENIZED
+#define LOG_TOKENIZED 0
+#endif
 
 enum class LogLevel {
-    NONE,
-    CRITICAL,
-    ERROR,
-    WARN,
-    INFO,
-    GAME_STATE,
-    DEBUG
+    NONE = LOG_LEVEL_NONE,
+    CRITICAL = LOG_LEVEL_CRITICAL,
+    ERROR = LOG_LEVEL_ERROR,
+    WARN = LOG_LEVEL_WARN,
+    INFO = LOG_LEVEL_INFO,
+    GAME_STATE = LOG_LEVEL_GAME_STATE,
+    DEBUG = LOG_LEVEL_DEBUG
+};
+
+constexpr uint8_t LOG_MAX_ARGS = 8;
+
+// Raw argument captured at the call site; formatting happens later on the drain task.
+union LogArg {
+    int64_t i;
+    double d;
+    const void* p;
+};
+
+// Two bits per argument in LogRecord::argKinds, also sent on the wire in tokenized mode.
+enum class LogArgKind : uint8_t {
+    INTEGER = 0,
+    FLOAT = 1,
+    STRING = 2,
+    POINTER = 3
 };
 
+#if LOG_TOKENIZED
+using LogFormat = uint32_t;
+#else
+using LogFormat = const char*;
+#endif
+
+struct LogRecord {
+    uint32_t timestamp;
+    LogLevel level;
+    uint8_t argCount;
+    uint16_t argKinds;
+    LogFormat format;
+    LogArg args[LOG_MAX_ARGS];
+};
+
+// Logging is deferred: callers push a LogRecord into a bounded MPSC ring in
+// constant time and a low-priority task formats and writes it. Format strings
+// and %s arguments must therefore point to storage with static lifetime.
 class DebugLogger {
 public:
+    static constexpr uint8_t MAX_ARGS = LOG_MAX_ARGS;
+    static constexpr uint32_t QUEUE_SIZE = 32;  // Must be a power of two
+
+    // Token of the internal "records dropped" message in tokenized mode.
+    static constexpr uint32_t DROPPED_TOKEN = 0;
+    // High nibble of the first byte of every tokenized frame; the low nibble is the level.
+    static constexpr uint8_t FRAME_SYNC = 0xA0;
+
     static void init(Stream& stream, LogLevel level = LogLevel::CRITICAL);
     static void setLogLevel(LogLevel level);
 
-    static void critical(const char* format, ...);
-    static void error(const char* format, ...);
-    static void warn(const char* format, ...);
-    static void info(const char* format, ...);
-    static void gameState(const char* format, ...);
-    static void debug(const char* format, ...);
+    // Writes out every pending record on the calling task.
+    static void flush();
+    // Without the drain task, as on the host, records drain as they are
+    // enqueued. Holding them leaves them in the ring until flush(), so a
+    // benchmark can time the enqueue alone.
+    static void setHoldUntilFlush(bool hold);
+    static uint32_t getDroppedCount();
+
+    // FNV-1a over the format string. tools/log_decoder computes the same hash
+    // when it builds the token table from the sources.
+    static constexpr uint32_t tokenize(const char* format) {
+        uint32_t hash = 2166136261u;
+        while (*format) {
+            hash = (hash ^ static_cast<uint8_t>(*format++)) * 16777619u;
+        }
+        return hash == DROPPED_TOKEN ? 1 : hash;
+    }
+
+    template <typename... Args>
+    static void critical(LogFormat format, Args... args) {
+        log(LogLevel::CRITICAL, format, args...);
+        flush();
+    }
+
+    template <typename... Args>
+    static void error(LogFormat format, Args... args) { log(LogLevel::ERROR, format, args...); }
+
+    template <typename... Args>
+    static void warn(LogFormat format, Args... args) { log(LogLevel::WARN, format, args...); }
+
+    template <typename... Args>
+    static void info(LogFormat format, Args... args) { log(LogLevel::INFO, format, args...); }
+
+    template <typename... Args>
+    static void gameState(LogFormat format, Args... args) { log(LogLevel::GAME_STATE, format, args...); }
+
+    template <typename... Args>
+    static void debug(LogFormat format, Args... args) { log(LogLevel::DEBUG, format, args...); }
 
 private:
-    static void log(LogLevel level, const char* format, va_list args);
+    static_assert((QUEUE_SIZE & (QUEUE_SIZE - 1)) == 0, "QUEUE_SIZE must be a power of two");
+
+    struct Slot {
+        std::atomic<uint32_t> sequence;
+        LogRecord record;
+    };
+
+    template <typename... Args>
+    static void log(LogLevel level, LogFormat format, Args... args) {
+        static_assert(sizeof...(Args) <= MAX_ARGS, "Too many log arguments");
+        if (!s_stream || level > s_logLevel) {
+            return;
+        }
+        const LogArg packed[sizeof...(Args) + 1] = {toLogArg(args)...};
+        enqueue(level, format, packed, sizeof...(Args), argKinds<Args...>());
+    }
+
+    template <typename T>
+    static constexpr LogArgKind kindOf() {
+        return std::is_floating_point<T>::value ? LogArgKind::FLOAT
+             : std::is_pointer<T>::value &&
+               std::is_same<typename std::remove_cv<typename std::remove_pointer<T>::type>::type, char>::value
+                 ? LogArgKind::STRING
+             : std::is_pointer<T>::value ? LogArgKind::POINTER
+             : LogArgKind::INTEGER;
+    }
+
+    template <typename... Args>
+    static constexpr uint16_t argKinds() {
+        uint16_t kinds = 0;
+        uint8_t index = 0;
+        (void)index;
+        ((kinds |= static_cast<uint16_t>(static_cast<uint16_t>(kindOf<Args>()) << (2 * index++))), ...);
+        return kinds;
+    }
+
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value, LogArg>::type
+    toLogArg(T value) {
+        LogArg arg;
+        arg.i = static_cast<int64_t>(value);
+        return arg;
+    }
+
+    template <typename T>
+    static typename std::enable_if<std::is_floating_point<T>::value, LogArg>::type
+    toLogArg(T value) {
+        LogArg arg;
+        arg.d = static_cast<double>(value);
+        return arg;
+    }
+
+    template <typename T>
+    static LogArg toLogArg(const T* value) {
+        LogArg arg;
+        arg.p = value;
+        return arg;
+    }
+
+    static void enqueue(LogLevel level, LogFormat format, const LogArg* args, uint8_t argCount, uint16_t argKinds);
+    static bool drain();
+    static void writeRecord(const LogRecord& record);
+    static void reportDropped(uint32_t dropped);
+#if LOG_TOKENIZED
+    static size_t encodeRecord(uint8_t* buffer, size_t size, const LogRecord& record);
+#else
+    static size_t formatRecord(char* buffer, size_t size, const LogRecord& record);
+#endif
+    static void drainTask(void* parameter);
     static const char* getLevelString(LogLevel level);
 
     static Stream* s_stream;
     static LogLevel s_logLevel;
-};
\ No newline at end of file
+    static Slot s_slots[QUEUE_SIZE];
+    static std::atomic<uint32_t> s_enqueuePos;
+    static uint32_t s_dequeuePos;
+    static std::atomic<bool> s_draining;
+    static std::atomic<uint32_t> s_dropped;
+    static uint32_t s_droppedReported;
+    static bool s_drainTaskRunning;
+    static bool s_holdUntilFlush;
+};
+
+#if LOG_TOKENIZED
+// Forcing the hash through a template argument keeps the literal out of flash.
+#define LOG_FORMAT(format) (std::integral_constant<uint32_t, DebugLogger::tokenize(format)>::value)
+#else
+#define LOG_FORMAT(format) (format)
+#endif
+
+// Call-site front-ends. Levels above LOG_LEVEL_MAX compile to nothing: the
+// call is kept inside if (false) so it is still type-checked, but neither the
+// call nor its arguments are evaluated. Compiled-in levels are still filtered
+// at runtime by DebugLogger::setLogLevel().
+#define LOG_CALL(method, format, ...) DebugLogger::method(LOG_FORMAT(format), ##__VA_ARGS__)
+#define LOG_DISCARD(format, ...) do { if (false) { LOG_CALL(debug, format, ##__VA_ARGS__); } } while (0)
+
+#if LOG_LEVEL_MAX >= LOG_LEVEL_CRITICAL
+#define LOG_CRITICAL(format, ...) LOG_CALL(critical, format, ##__VA_ARGS__)
+#else
+#define LOG_CRITICAL(format, ...) LOG_DISCARD(format, ##__VA_ARGS__)
+#endif
+
+#if LOG_LEVEL_MAX >= LOG_LEVEL_ERROR
+#define LOG_ERROR(format, ...) LOG_CALL(error, format, ##__VA_ARGS__)
+#else
+#define LOG_ERROR(format, ...) LOG_DISCARD(format, ##__VA_ARGS__)
+#endif
+
+#if LOG_LEVEL_MAX >= LOG_LEVEL_WARN
+#define LOG_WARN(format, ...) LOG_CALL(warn, format, ##__VA_ARGS__)
+#else
+#define LOG_WARN(format, ...) LOG_DISCARD(format, ##__VA_ARGS__)
+#endif
+
+#if LOG_LEVEL_MAX >= LOG_LEVEL_INFO
+#define LOG_INFO(format, ...) LOG_CALL(info, format, ##__VA_ARGS__)
+#else
+#define LOG_INFO(format, ...) LOG_DISCARD(format, ##__VA_ARGS__)
+#endif
+
+#if LOG_LEVEL_MAX >= LOG_LEVEL_GAME_STATE
+#define LOG_GAME_STATE(format, ...) LOG_CALL(gameState, format, ##__VA_ARGS__)
+#else
+#define LOG_GAME_STATE(format, ...) LOG_DISCARD(format, ##__VA_ARGS__)
+#endif
+
+#if LOG_LEVEL_MAX >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(format, ...) LOG_CALL(debug, format, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(format, ...) LOG_DISCARD(format, ##__VA_ARGS__)
+#endif
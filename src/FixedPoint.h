@@ -0,0 +1,80 @@
+#pragma once
+#include <stdint.h>
+#include <math.h>
+
+// Signed Q-format number: a 32-bit integer with FRAC_BITS fractional bits.
+// Used for the water levels on targets without an FPU, where every float
+// add or compare is a soft-float library call.
+template <uint8_t FracBits>
+class FixedPoint {
+public:
+    static constexpr uint8_t FRAC_BITS = FracBits;
+    static constexpr int32_t ONE = static_cast<int32_t>(1) << FracBits;
+
+    static_assert(FracBits > 0 && FracBits < 31, "Invalid fixed-point format");
+
+    constexpr FixedPoint() : value(0) {}
+    constexpr explicit FixedPoint(int whole) : value(static_cast<int32_t>(whole) * ONE) {}
+    // Rounds to the nearest step; meant for constants, which fold at compile time
+    constexpr explicit FixedPoint(float real)
+        : value(static_cast<int32_t>(real * ONE + (real >= 0 ? 0.5f : -0.5f))) {}
+
+    static constexpr FixedPoint fromRaw(int32_t raw) {
+        FixedPoint result;
+        result.value = raw;
+        return result;
+    }
+
+    constexpr int32_t raw() const { return value; }
+    constexpr float toFloat() const { return static_cast<float>(value) / ONE; }
+
+    constexpr FixedPoint operator+(FixedPoint other) const { return fromRaw(value + other.value); }
+    constexpr FixedPoint operator-(FixedPoint other) const { return fromRaw(value - other.value); }
+    constexpr FixedPoint operator-() const { return fromRaw(-value); }
+    constexpr FixedPoint operator*(FixedPoint other) const {
+        return fromRaw(static_cast<int32_t>((static_cast<int64_t>(value) * other.value) >> FracBits));
+    }
+    constexpr FixedPoint operator*(int32_t count) const { return fromRaw(value * count); }
+
+    FixedPoint& operator+=(FixedPoint other) { value += other.value; return *this; }
+    FixedPoint& operator-=(FixedPoint other) { value -= other.value; return *this; }
+
+    constexpr bool operator==(FixedPoint other) const { return value == other.value; }
+    constexpr bool operator!=(FixedPoint other) const { return value != other.value; }
+    constexpr bool operator<(FixedPoint other) const { return value < other.value; }
+    constexpr bool operator<=(FixedPoint other) const { return value <= other.value; }
+    constexpr bool operator>(FixedPoint other) const { return value > other.value; }
+    constexpr bool operator>=(FixedPoint other) const { return value >= other.value; }
+
+private:
+    int32_t value;
+};
+
+// Water levels in [0, 1]. Envs without an FPU build with -DHYDROLOGY_FIXED_POINT.
+// Q8.24 keeps the per-tick rounding of the rate constants near float precision.
+#ifdef HYDROLOGY_FIXED_POINT
+using WaterLevel = FixedPoint<24>;
+#else
+using WaterLevel = float;
+#endif
+
+// Helpers that let level code compile unchanged against either representation.
+constexpr float toFloat(float value) { return value; }
+
+template <uint8_t FracBits>
+constexpr float toFloat(FixedPoint<FracBits> value) { return value.toFloat(); }
+
+template <typename T>
+constexpr T clampValue(T value, T low, T high) {
+    return value < low ? low : (high < value ? high : value);
+}
+
+// round(value * scale) for non-negative values, e.g. a level to a row count.
+inline int32_t roundScaled(float value, int32_t scale) {
+    return static_cast<int32_t>(roundf(value * scale));
+}
+
+template <uint8_t FracBits>
+constexpr int32_t roundScaled(FixedPoint<FracBits> value, int32_t scale) {
+    return static_cast<int32_t>((static_cast<int64_t>(value.raw()) * scale + (FixedPoint<FracBits>::ONE >> 1)) >> FracBits);
+}
@@ -0,0 +1,20 @@
+#include "FrameStats.h"
+
+std::atomic<uint32_t> FrameStats::s_showCount(0);
+std::atomic<uint32_t> FrameStats::s_skippedShowCount(0);
+
+void FrameStats::recordShow() {
+    s_showCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FrameStats::recordSkippedShow() {
+    s_skippedShowCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint32_t FrameStats::getShowCount() {
+    return s_showCount.load(std::memory_order_relaxed);
+}
+
+uint32_t FrameStats::getSkippedShowCount() {
+    return s_skippedShowCount.load(std::memory_order_relaxed);
+}
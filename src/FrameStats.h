@@ -0,0 +1,17 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+
+// Counters for LED frames pushed to the strips versus frames skipped because
+// nothing visible changed.
+class FrameStats {
+public:
+    static void recordShow();
+    static void recordSkippedShow();
+    static uint32_t getShowCount();
+    static uint32_t getSkippedShowCount();
+
+private:
+    static std::atomic<uint32_t> s_showCount;
+    static std::atomic<uint32_t> s_skippedShowCount;
+};
@@ -2,19 +2,23 @@
 #include "config.h"
 #include "game_config.h"
 #include "DebugLogger.h"
+#include <algorithm>
 
 using namespace GameConfig;
 
-GameLogic::GameLogic(Scene& scene, SecondaryLEDHandler& secondaryLEDs) 
-    : scene(scene), secondaryLEDs(secondaryLEDs), currentState(GameState::WAITING_RAINING), 
-    stateStartTime(0), sewerLevel(0), basinLevel(0), basinGateOpen(false), gameActive(false) {
+GameLogic::GameLogic(Scene& scene, SecondaryLEDHandler& secondaryLEDs, const SimClock& clock, const GameParams& params)
+    : scene(scene), secondaryLEDs(secondaryLEDs), clock(clock), params(params),
+    rates(params),
+    currentState(GameState::WAITING_RAINING), 
+    stateStartTime(0), sewerLevel(GameBalance::LEVEL_EMPTY), basinLevel(GameBalance::LEVEL_EMPTY), basinGateOpen(false), gameActive(false),
+    lastStepTime(clock.now()), stepAccumulator(0), inputTrace(nullptr), frame(0), traceDumpRequested(false) {
     memset(buttonStates, 0, sizeof(buttonStates));
     initializeGameState();
 }
 
 void GameLogic::initializeGameState() {
     currentState = GameState::WAITING_RAINING;
-    stateStartTime = millis();
+    stateStartTime = clock.now();
     scene.setRainVisible(true);
     scene.setRainIntensity(RainVisuals::RAIN_INTENSITY_RAINING);
     scene.setPollutionState(false);
@@ -22,54 +26,132 @@ void GameLogic::initializeGameState() {
 }
 
 void GameLogic::update() {
+    drainInputs();
+    if (traceDumpRequested.exchange(false, std::memory_order_relaxed)) {
+        dumpTrace();
+    }
+    uint8_t steps = takeSimulationSteps();
     if (gameActive) {
-        updateActiveGame();
+        updateActiveGame(steps);
     } else if (currentState == GameState::WIN || currentState == GameState::FLOOD || currentState == GameState::BASIN_OVERFLOW) {
-        updateEndGameState();
+        updateEndGameState(steps);
     } else {
-        updateWaitingMode();
+        updateWaitingMode(steps);
     }
-    updateSecondaryLEDs();
+    scene.commitRenderState();
+    frame.fetch_add(1, std::memory_order_relaxed);
     
-    DebugLogger::debug("Update complete - State: %s, Sewer: %.2f, Basin: %.2f", 
-                       getStateString(), sewerLevel, basinLevel);
+    LOG_DEBUG("Update complete - State: %s, Sewer: %.2f, Basin: %.2f", 
+              getStateString(), toFloat(sewerLevel), toFloat(basinLevel));
+}
+
+// Rain and hydrology advance in fixed STEP_MS steps however often update()
+// runs. Time left over stays in the accumulator for the next call.
+uint8_t GameLogic::takeSimulationSteps() {
+    uint32_t now = clock.now();
+    stepAccumulator += now - lastStepTime;
+    lastStepTime = now;
+
+    uint32_t steps = stepAccumulator / Simulation::STEP_MS;
+    stepAccumulator -= steps * Simulation::STEP_MS;
+    if (steps > Simulation::MAX_STEPS_PER_UPDATE) {
+        LOG_WARN("Simulation behind by %lu steps, dropping the excess", steps - Simulation::MAX_STEPS_PER_UPDATE);
+        steps = Simulation::MAX_STEPS_PER_UPDATE;
+    }
+    return static_cast<uint8_t>(steps);
 }
 
-void GameLogic::updateActiveGame() {
-    DebugLogger::debug("Updating active game. Current state: %s", getStateString());
+void GameLogic::updateActiveGame(uint8_t steps) {
+    LOG_DEBUG("Updating active game. Current state: %s", getStateString());
     updateWeatherCycle();
-    updateWaterLevels();
+    for (uint8_t step = 0; step < steps; step++) {
+        stepRain();
+        applyRainImpacts();
+        for (uint8_t substep = 0; substep < Simulation::SUBSTEPS; substep++) {
+            updateWaterLevels();
+            handleBasinGate();
+        }
+    }
     updateRainIntensity();
-    handleGIEPEffects();
-    handleBasinGate();
     checkForStateTransition();
-    DebugLogger::debug("Active game update complete. Current state: %s", getStateString());
+    LOG_DEBUG("Active game update complete. Current state: %s", getStateString());
 }
 
-void GameLogic::updateWaitingMode() {
-    unsigned long currentTime = millis();
+void GameLogic::updateWaitingMode(uint8_t steps) {
+    unsigned long currentTime = clock.now();
     unsigned long stateDuration = currentTime - stateStartTime;
 
     if (currentState == GameState::WAITING_RAINING) {
-        sewerLevel += SewerMechanics::SEWER_INCREASE_RATE_RAINING - SewerMechanics::SEWER_DRAIN_RATE;
-        if (stateDuration >= Timing::WAITING_RAINING_DURATION) {
+        for (uint8_t step = 0; step < steps; step++) {
+            stepRain();
+            for (uint8_t substep = 0; substep < Simulation::SUBSTEPS; substep++) {
+                sewerLevel += rates.sewerIncreaseRaining - rates.sewerDrain;
+                sewerLevel = clampValue(sewerLevel, GameBalance::LEVEL_EMPTY, GameBalance::LEVEL_FULL);
+            }
+        }
+        if (stateDuration >= params.waitingRainingDuration) {
             transitionState(GameState::WAITING_DRY);
             scene.setRainVisible(false);
         }
     } else if (currentState == GameState::WAITING_DRY) {
-        sewerLevel -= SewerMechanics::SEWER_DRAIN_RATE;
-        if (stateDuration >= Timing::WAITING_DRY_DURATION) {
+        for (uint8_t step = 0; step < steps; step++) {
+            stepRain();
+            for (uint8_t substep = 0; substep < Simulation::SUBSTEPS; substep++) {
+                sewerLevel -= rates.sewerDrain;
+                sewerLevel = clampValue(sewerLevel, GameBalance::LEVEL_EMPTY, GameBalance::LEVEL_FULL);
+            }
+        }
+        if (stateDuration >= params.waitingDryDuration) {
             transitionState(GameState::WAITING_RAINING);
             scene.setRainVisible(true);
         }
     }
 
-    sewerLevel = max(0.0f, min(sewerLevel, 1.0f));
     scene.setSewerLevel(sewerLevel);
 }
 
+bool GameLogic::queueInput(InputSource source, uint8_t index, bool isPressed) {
+    return inputQueue.push(QueuedInput{clock.now(), source, index, isPressed});
+}
+
+// Applies queued inputs in arrival order, so a tick sees every edge that came
+// in since the previous one and none that arrive while it runs.
+void GameLogic::drainInputs() {
+    QueuedInput input;
+    while (inputQueue.pop(input)) {
+        LOG_DEBUG("Input waited %lu ms for the tick", static_cast<unsigned long>(clock.now() - input.timeMs));
+        if (input.source == InputSource::BASIN_GATE) {
+            handleBasinGateButton(input.pressed);
+        } else {
+            handleButton(input.index, input.pressed);
+        }
+    }
+}
+
+// Runs between ticks, so the game pauses while the trace goes out.
+void GameLogic::dumpTrace() {
+    if (!inputTrace) {
+        LOG_WARN("No input trace to dump");
+        return;
+    }
+    LOG_INFO("Dumping %u traced inputs", inputTrace->size());
+    // Keep queued log lines from interleaving with the dump
+    DebugLogger::flush();
+    inputTrace->dump(Serial, TaskConfig::GAME_UPDATE_INTERVAL_MS);
+}
+
+void GameLogic::recordInput(InputSource source, uint8_t index, bool isPressed) {
+    if (inputTrace) {
+        inputTrace->record(InputEvent{getFrame(), clock.now(), source, index, isPressed});
+    }
+}
+
 void GameLogic::handleButton(uint8_t buttonIndex, bool isPressed) {
-    DebugLogger::debug("Button %d %s", buttonIndex, isPressed ? "pressed" : "released");
+    LOG_DEBUG("Button %d %s", buttonIndex, isPressed ? "pressed" : "released");
+    if (isPressed && (currentState == GameState::WAITING_RAINING || currentState == GameState::WAITING_DRY)) {
+        beginTrace();  // This press starts a game
+    }
+    recordInput(InputSource::BUTTON, buttonIndex, isPressed);
 
     // Ignore button presses in all end game states
     if (currentState == GameState::WIN || currentState == GameState::FLOOD || currentState == GameState::BASIN_OVERFLOW) {
@@ -83,7 +165,7 @@ void GameLogic::handleButton(uint8_t buttonIndex, bool isPressed) {
                 handleGIEPButton(buttonIndex, isPressed);
                 scene.setGIEPState(buttonIndex, isPressed);
             } else if (buttonIndex == 8) {  // Basin gate button
-                handleBasinGateButton(isPressed);
+                setBasinGate(isPressed);
                 scene.setBasinGateState(isPressed);
             }
             updateGIEPAndBasinGateLEDs();
@@ -97,25 +179,41 @@ void GameLogic::handleButton(uint8_t buttonIndex, bool isPressed) {
         if (buttonIndex < 8) {  // GIEP buttons
             handleGIEPButton(buttonIndex, isPressed);
         } else if (buttonIndex == 8) {  // Basin gate button
-            handleBasinGateButton(isPressed);
+            setBasinGate(isPressed);
         }
     }
 }
 
+void GameLogic::setInputTrace(InputTrace* trace) {
+    inputTrace = trace;
+    beginTrace();
+}
+
+// A replay rebuilds the round from the trace header: startGame() resets the
+// rain and the step clock, so the rain generator state is all it needs.
+void GameLogic::beginTrace() {
+    if (inputTrace) {
+        inputTrace->begin(getFrame(), clock.now(), scene.getRainRandomState());
+    }
+}
+
 void GameLogic::startGame() {
-    DebugLogger::critical("Starting the game");
+    LOG_CRITICAL("Starting the game");
     gameActive = true;
-    sewerLevel = 0;
-    basinLevel = 0;
+    scene.resetRain();
+    stepAccumulator = 0;
+    lastStepTime = clock.now();
+    sewerLevel = GameBalance::LEVEL_EMPTY;
+    basinLevel = GameBalance::LEVEL_EMPTY;
     scene.setSewerLevel(sewerLevel);
     scene.setBasinLevel(basinLevel);
     scene.setPollutionState(false);
     currentState = GameState::RAINING;
-    stateStartTime = millis();
+    stateStartTime = clock.now();
     scene.setRainVisible(true);
     scene.setRainIntensity(RainVisuals::RAIN_INTENSITY_RAINING);
     updateSecondaryLEDs();
-    DebugLogger::critical("Game started. Initial state: %s", getStateString());
+    LOG_CRITICAL("Game started. Initial state: %s", getStateString());
 }
 
 void GameLogic::handleGIEPButton(uint8_t buttonIndex, bool isPressed) {
@@ -139,9 +237,14 @@ void GameLogic::handleGIEPButton(uint8_t buttonIndex, bool isPressed) {
 }
 
 void GameLogic::handleBasinGateButton(bool isPressed) {
-    basinGateOpen = isPressed;
-    scene.setBasinGateState(isPressed);
-    secondaryLEDs.setZoneState(SecondaryLEDZone::BASIN_GATE, isPressed);
+    recordInput(InputSource::BASIN_GATE, 8, isPressed);
+    setBasinGate(isPressed);
+}
+
+void GameLogic::setBasinGate(bool isOpen) {
+    basinGateOpen = isOpen;
+    scene.setBasinGateState(isOpen);
+    secondaryLEDs.setZoneState(SecondaryLEDZone::BASIN_GATE, isOpen);
 }
 
 const char* GameLogic::getStateString() const {
@@ -163,79 +266,101 @@ const char* GameLogic::getStateString(GameState state) const {
 }
 
 void GameLogic::transitionState(GameState newState) {
-    DebugLogger::critical("Game state transition: %s -> %s", getStateString(), getStateString(newState));
+    LOG_CRITICAL("Game state transition: %s -> %s", getStateString(), getStateString(newState));
     currentState = newState;
-    stateStartTime = millis();
+    stateStartTime = clock.now();
     updateSecondaryLEDs();
 }
 
 void GameLogic::updateWeatherCycle() {
-    unsigned long currentTime = millis();
+    unsigned long currentTime = clock.now();
     unsigned long stateDuration = currentTime - stateStartTime;
 
-    if (currentState == GameState::RAINING && stateDuration >= Timing::RAINING_DURATION) {
+    if (currentState == GameState::RAINING && stateDuration >= params.rainingDuration) {
         transitionState(GameState::HEAVY);
-    } else if (currentState == GameState::HEAVY && stateDuration >= Timing::HEAVY_DURATION) {
+    } else if (currentState == GameState::HEAVY && stateDuration >= params.heavyDuration) {
         transitionState(GameState::STORM);
-    } else if (currentState == GameState::STORM && stateDuration >= Timing::STORM_DURATION) {
-        DebugLogger::critical("STORM duration ended. Checking win condition.");
-        if (sewerLevel <= GameBalance::WIN_THRESHOLD && basinLevel <= GameBalance::WIN_THRESHOLD) {
-            DebugLogger::critical("Win condition met at the end of STORM. Ending game with WIN state.");
+    } else if (currentState == GameState::STORM && stateDuration >= params.stormDuration) {
+        LOG_CRITICAL("STORM duration ended. Checking win condition.");
+        if (sewerLevel <= rates.winThreshold && basinLevel <= rates.winThreshold) {
+            LOG_CRITICAL("Win condition met at the end of STORM. Ending game with WIN state.");
             endGame(GameState::WIN);
         } else {
-            DebugLogger::critical("Win condition not met. Transitioning back to RAINING state.");
+            LOG_CRITICAL("Win condition not met. Transitioning back to RAINING state.");
             transitionState(GameState::RAINING);
         }
     }
 }
 
+// One fixed step of the scene's rain; the drops that landed wait in
+// rainImpacts for applyRainImpacts().
+void GameLogic::stepRain() {
+    scene.stepRain();
+    rainImpacts = scene.takeRainImpacts();
+}
+
+void GameLogic::applyRainImpacts() {
+    // Rain landed on roofs and sewers feeds the sewer, as does rain on a GIEP
+    // that is not active; the basin collects the rain falling on it directly.
+    uint16_t sewerImpacts = rainImpacts[RainZone::SEWER];
+    for (int i = 0; i < 8; i++) {
+        if (!buttonStates[i]) {
+            sewerImpacts += rainImpacts[static_cast<RainZone>(static_cast<int>(RainZone::GIEP_1) + i)];
+        }
+    }
+    uint16_t basinImpacts = rainImpacts[RainZone::BASIN];
+    sewerLevel += rates.rainImpact * static_cast<int32_t>(sewerImpacts);
+    basinLevel += rates.rainImpact * static_cast<int32_t>(basinImpacts);
+    LOG_DEBUG("Rain impacts - Sewer: %u, Basin: %u", sewerImpacts, basinImpacts);
+}
+
+// One substep of the sewer and basin model.
 void GameLogic::updateWaterLevels() {
-    float sewerIncreaseRate = 0.0f;
+    WaterLevel sewerIncreaseRate = GameBalance::LEVEL_EMPTY;
     switch (currentState) {
         case GameState::RAINING:
-            sewerIncreaseRate = SewerMechanics::SEWER_INCREASE_RATE_RAINING;
+            sewerIncreaseRate = rates.sewerIncreaseRaining;
             break;
         case GameState::HEAVY:
-            sewerIncreaseRate = SewerMechanics::SEWER_INCREASE_RATE_HEAVY;
+            sewerIncreaseRate = rates.sewerIncreaseHeavy;
             break;
         case GameState::STORM:
-            sewerIncreaseRate = SewerMechanics::SEWER_INCREASE_RATE_STORM;
+            sewerIncreaseRate = rates.sewerIncreaseStorm;
             break;
         default:
             break;
     }
 
-    float giepEffect = 0;
+    WaterLevel giepEffect = GameBalance::LEVEL_EMPTY;
     for (int i = 0; i < 8; i++) {
         if (buttonStates[i]) {
-            giepEffect += SewerMechanics::GIEP_EFFECT_STRENGTH;
+            giepEffect += rates.giepEffect;
         }
     }
 
     if (currentState == GameState::RAINING || currentState == GameState::HEAVY || currentState == GameState::STORM) {
-        sewerLevel += sewerIncreaseRate - giepEffect - SewerMechanics::SEWER_DRAIN_RATE;
+        sewerLevel += sewerIncreaseRate - giepEffect - rates.sewerDrain;
     } else {
-        sewerLevel -= SewerMechanics::SEWER_DRAIN_RATE;
+        sewerLevel -= rates.sewerDrain;
     }
-    sewerLevel = max(0.0f, min(sewerLevel, 1.0f));
+    sewerLevel = clampValue(sewerLevel, GameBalance::LEVEL_EMPTY, GameBalance::LEVEL_FULL);
 
     if (basinGateOpen) {
-        float transferAmount = min(SewerMechanics::BASIN_GATE_TRANSFER_RATE, sewerLevel);
+        WaterLevel transferAmount = std::min(rates.basinGateTransfer, sewerLevel);
         sewerLevel -= transferAmount;
         basinLevel += transferAmount;
     }
-    basinLevel = max(0.0f, min(basinLevel, 1.0f));
+    basinLevel = clampValue(basinLevel, GameBalance::LEVEL_EMPTY, GameBalance::LEVEL_FULL);
 
     scene.setSewerLevel(sewerLevel);
     scene.setBasinLevel(basinLevel);
 
-    DebugLogger::critical("Water levels updated - State: %s, Sewer: %.2f, Basin: %.2f, Increase Rate: %.3f, GIEP: %.3f", 
-                          getStateString(), sewerLevel, basinLevel, sewerIncreaseRate, giepEffect);
+    LOG_GAME_STATE("Water levels updated - State: %s, Sewer: %.2f, Basin: %.2f, Increase Rate: %.3f, GIEP: %.3f", 
+                  getStateString(), toFloat(sewerLevel), toFloat(basinLevel), toFloat(sewerIncreaseRate), toFloat(giepEffect));
 }
 
 void GameLogic::updateRainIntensity() {
     float intensity;
-    RainLevel rainLevel = RainLevel::NONE;
     switch (currentState) {
         case GameState::WAITING_DRY:
             intensity = 0.0f;
@@ -245,17 +370,14 @@ void GameLogic::updateRainIntensity() {
         case GameState::RAINING:
             intensity = RainVisuals::RAIN_INTENSITY_RAINING;
             scene.setRainVisible(true);
-            rainLevel = RainLevel::LIGHT;
             break;
         case GameState::HEAVY:
             intensity = RainVisuals::RAIN_INTENSITY_HEAVY;
             scene.setRainVisible(true);
-            rainLevel = RainLevel::MODERATE;
             break;
         case GameState::STORM:
             intensity = RainVisuals::RAIN_INTENSITY_STORM;
             scene.setRainVisible(true);
-            rainLevel = RainLevel::HEAVY;
             break;
         default:
             intensity = 0.0f;
@@ -263,7 +385,6 @@ void GameLogic::updateRainIntensity() {
             break;
     }
     scene.setRainIntensity(intensity);
-    secondaryLEDs.setRainLevel(rainLevel);
 }
 
 void GameLogic::handleGIEPEffects() {
@@ -276,66 +397,69 @@ void GameLogic::handleGIEPEffects() {
 
 void GameLogic::handleBasinGate() {
     if (basinGateOpen) {
-        float transferAmount = min(SewerMechanics::BASIN_GATE_TRANSFER_RATE * sewerLevel, GameBalance::BASIN_OVERFLOW_THRESHOLD - basinLevel);
+        WaterLevel transferAmount = std::min(rates.basinGateTransfer * sewerLevel, rates.basinOverflowThreshold - basinLevel);
         sewerLevel -= transferAmount;
         basinLevel += transferAmount;
         
         scene.setSewerLevel(sewerLevel);
         scene.setBasinLevel(basinLevel);
         
-        DebugLogger::debug("Basin gate transfer - Amount: %.2f, New Sewer Level: %.2f, New Basin Level: %.2f",
-                           transferAmount, sewerLevel, basinLevel);
+        LOG_DEBUG("Basin gate transfer - Amount: %.2f, New Sewer Level: %.2f, New Basin Level: %.2f",
+                  toFloat(transferAmount), toFloat(sewerLevel), toFloat(basinLevel));
     }
 }
 
 void GameLogic::checkForStateTransition() {
-    DebugLogger::critical("Checking state transition - Current State: %s, Sewer Level: %.2f, Basin Level: %.2f", 
-                          getStateString(), sewerLevel, basinLevel);
+    LOG_GAME_STATE("Checking state transition - Current State: %s, Sewer Level: %.2f, Basin Level: %.2f", 
+                  getStateString(), toFloat(sewerLevel), toFloat(basinLevel));
 
-    if (sewerLevel >= GameBalance::SEWER_OVERFLOW_THRESHOLD) {
-        DebugLogger::critical("Sewer overflow detected. Ending game with FLOOD state.");
+    if (sewerLevel >= rates.sewerOverflowThreshold) {
+        LOG_CRITICAL("Sewer overflow detected. Ending game with FLOOD state.");
         endGame(GameState::FLOOD);
-    } else if (basinLevel >= GameBalance::BASIN_OVERFLOW_THRESHOLD) {
-        DebugLogger::critical("Basin overflow detected. Ending game with BASIN_OVERFLOW state.");
+    } else if (basinLevel >= rates.basinOverflowThreshold) {
+        LOG_CRITICAL("Basin overflow detected. Ending game with BASIN_OVERFLOW state.");
         endGame(GameState::BASIN_OVERFLOW);
     } else if (currentState == GameState::STORM) {
-        unsigned long stormDuration = millis() - stateStartTime;
-        if (stormDuration >= Timing::STORM_DURATION) {
-            if (sewerLevel <= GameBalance::WIN_THRESHOLD && basinLevel <= GameBalance::WIN_THRESHOLD) {
-                DebugLogger::critical("Win condition met at the end of STORM. Ending game with WIN state.");
+        unsigned long stormDuration = clock.now() - stateStartTime;
+        if (stormDuration >= params.stormDuration) {
+            if (sewerLevel <= rates.winThreshold && basinLevel <= rates.winThreshold) {
+                LOG_CRITICAL("Win condition met at the end of STORM. Ending game with WIN state.");
                 endGame(GameState::WIN);
             } else {
-                DebugLogger::critical("STORM duration ended. Transitioning to RAINING state.");
+                LOG_CRITICAL("STORM duration ended. Transitioning to RAINING state.");
                 transitionState(GameState::RAINING);
             }
         } else {
-            DebugLogger::debug("STORM in progress. Duration: %lu / %lu", stormDuration, Timing::STORM_DURATION);
+            LOG_DEBUG("STORM in progress. Duration: %lu / %lu", stormDuration, params.stormDuration);
         }
     }
 }
 
 void GameLogic::endGame(GameState endState) {
-    DebugLogger::critical("Ending game. Previous state: %s, New state: %s", getStateString(), getStateString(endState));
+    LOG_CRITICAL("Ending game. Previous state: %s, New state: %s", getStateString(), getStateString(endState));
     gameActive = false;
     currentState = endState;
-    stateStartTime = millis();
+    stateStartTime = clock.now();
     
     if (endState == GameState::BASIN_OVERFLOW) {
         scene.setPollutionState(true);
     } else if (endState == GameState::FLOOD) {
-        sewerLevel = 1.0f;
+        sewerLevel = GameBalance::LEVEL_FULL;
         scene.setSewerLevel(sewerLevel);
         scene.setFloodState(true);
-        DebugLogger::critical("FLOOD state set. Sewer level set to maximum: %.2f", sewerLevel);
+        LOG_CRITICAL("FLOOD state set. Sewer level set to maximum: %.2f", toFloat(sewerLevel));
     } else if (endState == GameState::WIN) {
-        DebugLogger::critical("WIN state set. Updating secondary LEDs for WIN state.");
+        LOG_CRITICAL("WIN state set. Updating secondary LEDs for WIN state.");
     }
     
     updateSecondaryLEDs();
 }
 
-void GameLogic::updateEndGameState() {
-    unsigned long currentTime = millis();
+void GameLogic::updateEndGameState(uint8_t steps) {
+    for (uint8_t step = 0; step < steps; step++) {
+        stepRain();
+    }
+    unsigned long currentTime = clock.now();
     unsigned long stateDuration = currentTime - stateStartTime;
 
     if (currentState == GameState::BASIN_OVERFLOW) {
@@ -349,18 +473,35 @@ void GameLogic::updateEndGameState() {
     }
 
     // Check if we need to transition back to waiting state
-    if (stateDuration >= Timing::END_STATE_DURATION) {
-        DebugLogger::critical("End game state duration exceeded. Transitioning to waiting state.");
+    if (stateDuration >= params.endStateDuration) {
+        LOG_CRITICAL("End game state duration exceeded. Transitioning to waiting state.");
         initializeGameState();
         resetGameElements();
     }
 }
 
+// Pushes the whole secondary strip state after a game state change. Button
+// handlers push their own zone, so nothing needs refreshing per tick.
 void GameLogic::updateSecondaryLEDs() {
+    // Update rain level indicators; they go dark once the game is over
+    switch (currentState) {
+        case GameState::RAINING:
+            secondaryLEDs.setRainLevel(RainLevel::LIGHT);
+            break;
+        case GameState::HEAVY:
+            secondaryLEDs.setRainLevel(RainLevel::MODERATE);
+            break;
+        case GameState::STORM:
+            secondaryLEDs.setRainLevel(RainLevel::HEAVY);
+            break;
+        default:
+            secondaryLEDs.setRainLevel(RainLevel::NONE);
+            break;
+    }
+
     if (currentState == GameState::WIN) {
-        DebugLogger::debug("Updating secondary LEDs for WIN state");
-        secondaryLEDs.setEndGameState(SecondaryLEDZone::WIN);
-        handleGIEPEffects();  // Keep GIEP zones blinking in WIN state
+        LOG_DEBUG("Updating secondary LEDs for WIN state");
+        secondaryLEDs.setEndGameState(SecondaryLEDZone::WIN);  // Blinks the GIEP zones itself
     } else if (currentState == GameState::FLOOD) {
         secondaryLEDs.setEndGameState(SecondaryLEDZone::FLOOD_DEATH);
         secondaryLEDs.setFloodZoneColor(255, 0, 0);  // Set flood zone color to red
@@ -368,22 +509,6 @@ void GameLogic::updateSecondaryLEDs() {
         secondaryLEDs.setEndGameState(SecondaryLEDZone::POLLUTION_DEATH);
     } else {
         secondaryLEDs.setEndGameState(SecondaryLEDZone::NONE);
-        
-        // Update rain level indicators
-        switch (currentState) {
-            case GameState::RAINING:
-                secondaryLEDs.setRainLevel(RainLevel::LIGHT);
-                break;
-            case GameState::HEAVY:
-                secondaryLEDs.setRainLevel(RainLevel::MODERATE);
-                break;
-            case GameState::STORM:
-                secondaryLEDs.setRainLevel(RainLevel::HEAVY);
-                break;
-            default:
-                secondaryLEDs.setRainLevel(RainLevel::NONE);
-                break;
-        }
 
         // Update GIEP and Basin Gate LEDs
         handleGIEPEffects();
@@ -392,8 +517,8 @@ void GameLogic::updateSecondaryLEDs() {
 }
 
 void GameLogic::resetGameElements() {
-    sewerLevel = 0;
-    basinLevel = 0;
+    sewerLevel = GameBalance::LEVEL_EMPTY;
+    basinLevel = GameBalance::LEVEL_EMPTY;
     scene.setSewerLevel(sewerLevel);
     scene.setBasinLevel(basinLevel);
     scene.setPollutionState(false);
@@ -409,15 +534,9 @@ void GameLogic::resetGameElements() {
         scene.setGIEPState(i, false);
     }
     
-    // Update secondary LEDs
-    secondaryLEDs.setRainLevel(RainLevel::LIGHT);
-    secondaryLEDs.setZoneState(SecondaryLEDZone::BASIN_GATE, false);
-    for (int i = 0; i < 8; i++) {
-        SecondaryLEDZone zone = static_cast<SecondaryLEDZone>(static_cast<int>(SecondaryLEDZone::GIEP_1) + i);
-        secondaryLEDs.setZoneState(zone, false);
-    }
-    
-    DebugLogger::critical("Game elements reset completed");
+    updateSecondaryLEDs();
+
+    LOG_CRITICAL("Game elements reset completed");
 }
 
 void GameLogic::updateGIEPAndBasinGateLEDs() {
@@ -427,9 +546,9 @@ void GameLogic::updateGIEPAndBasinGateLEDs() {
 
 void GameLogic::checkEndGameTransition() {
     if (currentState == GameState::WIN || currentState == GameState::FLOOD || currentState == GameState::BASIN_OVERFLOW) {
-        unsigned long endStateDuration = millis() - stateStartTime;
-        if (endStateDuration >= Timing::END_STATE_DURATION) {
-            DebugLogger::critical("End game state duration exceeded. Transitioning to waiting state.");
+        unsigned long endStateDuration = clock.now() - stateStartTime;
+        if (endStateDuration >= params.endStateDuration) {
+            LOG_CRITICAL("End game state duration exceeded. Transitioning to waiting state.");
             initializeGameState();
             resetGameElements();
         }
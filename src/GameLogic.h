@@ -3,6 +3,11 @@
 
 #include "Scene.h"
 #include "SecondaryLEDHandler.h"
+#include "SimClock.h"
+#include "GameParams.h"
+#include "InputTrace.h"
+#include "SpscQueue.h"
+#include <atomic>
 
 enum class GameState {
     WAITING_RAINING,
@@ -15,19 +20,44 @@ enum class GameState {
     WIN
 };
 
+// A debounced button edge on its way from the button task to the game task.
+struct QueuedInput {
+    uint32_t timeMs;  // Clock time the edge was queued
+    InputSource source;
+    uint8_t index;
+    bool pressed;
+};
+
+// update() and the handle* calls run on the game task. The button task only
+// queues inputs and requests trace dumps; both are picked up at the start of
+// the next update().
 class GameLogic {
 public:
-    GameLogic(Scene& scene, SecondaryLEDHandler& secondaryLEDs);
+    GameLogic(Scene& scene, SecondaryLEDHandler& secondaryLEDs, const SimClock& clock, const GameParams& params);
     void update();
     void handleButton(uint8_t buttonIndex, bool isPressed);
     void handleBasinGateButton(bool isPressed);
+    // Button task side. Returns false, dropping the input, when the game task
+    // has fallen a whole queue behind.
+    bool queueInput(InputSource source, uint8_t index, bool isPressed);
+    void requestTraceDump() { traceDumpRequested.store(true, std::memory_order_relaxed); }
     GameState getState() const { return currentState; }
+    WaterLevel getSewerLevel() const { return sewerLevel; }
+    WaterLevel getBasinLevel() const { return basinLevel; }
     const char* getStateString() const;
     const char* getStateString(GameState state) const;
     void initializeGameState();
 
+    // Records every button input into `trace`, beginning a fresh trace now
+    // and with every game started; nullptr stops recording.
+    void setInputTrace(InputTrace* trace);
+    uint32_t getFrame() const { return frame.load(std::memory_order_relaxed); }
+
 private:
     void transitionState(GameState newState);
+    uint8_t takeSimulationSteps();
+    void stepRain();
+    void applyRainImpacts();
     void updateWaterLevels();
     void checkForStateTransition();
     void updateRainIntensity();
@@ -35,25 +65,40 @@ private:
     void handleBasinGate();
     void updateWeatherCycle();  
     void handleGIEPButton(uint8_t buttonIndex, bool isPressed);
+    void setBasinGate(bool isOpen);
+    void beginTrace();
+    void recordInput(InputSource source, uint8_t index, bool isPressed);
+    void drainInputs();
+    void dumpTrace();
     void updateSecondaryLEDs();
-    void updateWaitingMode();
-    void updateActiveGame();
+    void updateWaitingMode(uint8_t steps);
+    void updateActiveGame(uint8_t steps);
     void startGame();
     void endGame(GameState endState);
     void updateGIEPAndBasinGateLEDs();
     void checkEndGameTransition();
     void resetGameElements();
-    void updateEndGameState();  // Added the new function declaration
+    void updateEndGameState(uint8_t steps);
 
     Scene& scene;
     SecondaryLEDHandler& secondaryLEDs;
+    const SimClock& clock;
+    const GameParams params;
+    const LevelRates rates;
     GameState currentState;
     unsigned long stateStartTime;
-    float sewerLevel;
-    float basinLevel;
+    WaterLevel sewerLevel;
+    WaterLevel basinLevel;
     bool basinGateOpen;
     bool buttonStates[8];
     bool gameActive;
+    RainImpacts rainImpacts;  // Drops landed in the current step
+    uint32_t lastStepTime;
+    uint32_t stepAccumulator;  // Simulated time not yet integrated, in ms
+    InputTrace* inputTrace;
+    std::atomic<uint32_t> frame;  // Updates completed
+    SpscQueue<QueuedInput, GameConfig::Diagnostics::INPUT_QUEUE_CAPACITY> inputQueue;
+    std::atomic<bool> traceDumpRequested;
 };
 
 #endif // GAME_LOGIC_H
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+#include <stdint.h>
+#include "game_config.h"
+
+// Balance values GameLogic reads at runtime. The firmware plays with
+// defaults(), taken from GameConfig; the native simulator varies them to tune
+// the game. Rates are per second of simulated time.
+struct GameParams {
+    // Timing, in ms
+    uint32_t waitingRainingDuration;
+    uint32_t waitingDryDuration;
+    uint32_t rainingDuration;
+    uint32_t heavyDuration;
+    uint32_t stormDuration;
+    uint32_t endStateDuration;
+
+    // SewerMechanics
+    float sewerIncreaseRateRaining;
+    float sewerIncreaseRateHeavy;
+    float sewerIncreaseRateStorm;
+    float giepEffectStrength;
+    float sewerDrainRate;
+    float basinGateTransferRate;
+    float rainImpactQuantum;
+
+    // GameBalance
+    float sewerOverflowThreshold;
+    float basinOverflowThreshold;
+    float winThreshold;
+
+    static constexpr GameParams defaults() {
+        using namespace GameConfig;
+        return GameParams{
+            Timing::WAITING_RAINING_DURATION,
+            Timing::WAITING_DRY_DURATION,
+            Timing::RAINING_DURATION,
+            Timing::HEAVY_DURATION,
+            Timing::STORM_DURATION,
+            Timing::END_STATE_DURATION,
+            SewerMechanics::SEWER_INCREASE_RATE_RAINING,
+            SewerMechanics::SEWER_INCREASE_RATE_HEAVY,
+            SewerMechanics::SEWER_INCREASE_RATE_STORM,
+            SewerMechanics::GIEP_EFFECT_STRENGTH,
+            SewerMechanics::SEWER_DRAIN_RATE,
+            SewerMechanics::BASIN_GATE_TRANSFER_RATE,
+            toFloat(SewerMechanics::RAIN_IMPACT_QUANTUM),
+            toFloat(GameBalance::SEWER_OVERFLOW_THRESHOLD),
+            toFloat(GameBalance::BASIN_OVERFLOW_THRESHOLD),
+            toFloat(GameBalance::WIN_THRESHOLD),
+        };
+    }
+};
+
+// GameParams converted once to levels; rates become the amount per substep,
+// Simulation::SUBSTEPS of which make one fixed Simulation::STEP_MS step. The
+// rain impact quantum stays per landed drop.
+struct LevelRates {
+    WaterLevel sewerIncreaseRaining;
+    WaterLevel sewerIncreaseHeavy;
+    WaterLevel sewerIncreaseStorm;
+    WaterLevel giepEffect;
+    WaterLevel sewerDrain;
+    WaterLevel basinGateTransfer;
+    WaterLevel rainImpact;
+    WaterLevel sewerOverflowThreshold;
+    WaterLevel basinOverflowThreshold;
+    WaterLevel winThreshold;
+
+    explicit LevelRates(const GameParams& params)
+        : sewerIncreaseRaining(perSubstep(params.sewerIncreaseRateRaining)),
+          sewerIncreaseHeavy(perSubstep(params.sewerIncreaseRateHeavy)),
+          sewerIncreaseStorm(perSubstep(params.sewerIncreaseRateStorm)),
+          giepEffect(perSubstep(params.giepEffectStrength)),
+          sewerDrain(perSubstep(params.sewerDrainRate)),
+          basinGateTransfer(perSubstep(params.basinGateTransferRate)),
+          rainImpact(params.rainImpactQuantum),
+          sewerOverflowThreshold(params.sewerOverflowThreshold),
+          basinOverflowThreshold(params.basinOverflowThreshold),
+          winThreshold(params.winThreshold) {}
+
+private:
+    static WaterLevel perSubstep(float ratePerSecond) {
+        return WaterLevel(ratePerSecond * GameConfig::Simulation::STEP_MS / 1000.0f / GameConfig::Simulation::SUBSTEPS);
+    }
+};
@@ -0,0 +1,142 @@
+#include "InputTrace.h"
+#include "GameLogic.h"
+
+namespace {
+
+void putU16(uint8_t* out, uint16_t value) {
+    out[0] = value & 0xFF;
+    out[1] = value >> 8;
+}
+
+void putU32(uint8_t* out, uint32_t value) {
+    for (uint8_t i = 0; i < 4; i++) {
+        out[i] = (value >> (8 * i)) & 0xFF;
+    }
+}
+
+uint16_t getU16(const uint8_t* in) {
+    return static_cast<uint16_t>(in[0] | (in[1] << 8));
+}
+
+uint32_t getU32(const uint8_t* in) {
+    return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+           (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+// Hex-encodes `size` bytes as one "TRACE ..." line.
+void printHexLine(Stream& stream, const uint8_t* data, size_t size) {
+    static const char DIGITS[] = "0123456789ABCDEF";
+    char line[6 + 2 * InputTrace::HEADER_SIZE + 1] = "TRACE ";
+    size_t pos = 6;
+    for (size_t i = 0; i < size; i++) {
+        line[pos++] = DIGITS[data[i] >> 4];
+        line[pos++] = DIGITS[data[i] & 0x0F];
+    }
+    line[pos] = '\0';
+    stream.println(line);
+}
+
+}  // namespace
+
+InputTrace::InputTrace() : head(0), count(0), startFrame(0), startTimeMs(0), rainState(0), dropped(0) {}
+
+void InputTrace::begin(uint32_t frame, uint32_t timeMs, uint32_t state) {
+    head = 0;
+    count = 0;
+    startFrame = frame;
+    startTimeMs = timeMs;
+    rainState = state;
+    dropped = 0;
+}
+
+void InputTrace::record(const InputEvent& event) {
+    events[head] = event;
+    head = (head + 1) % CAPACITY;
+    if (count < CAPACITY) {
+        count++;
+    } else {
+        dropped++;
+    }
+}
+
+const InputEvent& InputTrace::at(uint16_t i) const {
+    return events[(head + CAPACITY - count + i) % CAPACITY];
+}
+
+InputTraceHeader InputTrace::header(uint16_t tickMs) const {
+    return InputTraceHeader{tickMs, rainState, startFrame, startTimeMs, count, dropped};
+}
+
+void InputTrace::dump(Stream& stream, uint16_t tickMs) const {
+    char line[32];
+    snprintf(line, sizeof(line), "TRACE BEGIN %u", count);
+    stream.println(line);
+
+    uint8_t buffer[HEADER_SIZE];
+    encodeHeader(buffer, header(tickMs));
+    printHexLine(stream, buffer, HEADER_SIZE);
+    for (uint16_t i = 0; i < count; i++) {
+        encodeEvent(buffer, at(i));
+        printHexLine(stream, buffer, EVENT_SIZE);
+    }
+    stream.println("TRACE END");
+}
+
+void InputTrace::encodeHeader(uint8_t* out, const InputTraceHeader& header) {
+    putU32(out, MAGIC);
+    putU16(out + 4, VERSION);
+    putU16(out + 6, header.tickMs);
+    putU32(out + 8, header.rainState);
+    putU32(out + 12, header.startFrame);
+    putU32(out + 16, header.startTimeMs);
+    putU32(out + 20, header.eventCount);
+    putU32(out + 24, header.droppedCount);
+}
+
+bool InputTrace::decodeHeader(const uint8_t* in, InputTraceHeader& header) {
+    if (getU32(in) != MAGIC || getU16(in + 4) != VERSION) {
+        return false;
+    }
+    header.tickMs = getU16(in + 6);
+    header.rainState = getU32(in + 8);
+    header.startFrame = getU32(in + 12);
+    header.startTimeMs = getU32(in + 16);
+    header.eventCount = getU32(in + 20);
+    header.droppedCount = getU32(in + 24);
+    return true;
+}
+
+void InputTrace::encodeEvent(uint8_t* out, const InputEvent& event) {
+    putU32(out, event.frame);
+    putU32(out + 4, event.timeMs);
+    out[8] = static_cast<uint8_t>(event.source);
+    out[9] = event.index;
+    out[10] = event.pressed;
+}
+
+InputEvent InputTrace::decodeEvent(const uint8_t* in) {
+    return InputEvent{getU32(in), getU32(in + 4), static_cast<InputSource>(in[8]), in[9], in[10] != 0};
+}
+
+InputReplay::InputReplay(const InputEvent* events, uint32_t count, uint32_t startFrame)
+    : events(events), count(count), startFrame(startFrame), next(0) {}
+
+void InputReplay::applyBeforeAdvance(uint32_t frame, uint32_t nowMs, GameLogic& game) {
+    while (next < count && events[next].frame - startFrame == frame && events[next].timeMs <= nowMs) {
+        apply(events[next++], game);
+    }
+}
+
+void InputReplay::applyAfterAdvance(uint32_t frame, GameLogic& game) {
+    while (next < count && events[next].frame - startFrame <= frame) {
+        apply(events[next++], game);
+    }
+}
+
+void InputReplay::apply(const InputEvent& event, GameLogic& game) {
+    if (event.source == InputSource::BASIN_GATE) {
+        game.handleBasinGateButton(event.pressed);
+    } else {
+        game.handleButton(event.index, event.pressed);
+    }
+}
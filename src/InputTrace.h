@@ -0,0 +1,98 @@
+#pragma once
+#include <Arduino.h>
+#include "game_config.h"
+
+class GameLogic;
+
+// Which GameLogic entry point an input went through; they differ in waiting
+// mode, where only handleButton starts a game.
+enum class InputSource : uint8_t {
+    BUTTON,     // handleButton(index, pressed)
+    BASIN_GATE  // handleBasinGateButton(pressed)
+};
+
+struct InputEvent {
+    uint32_t frame;   // GameLogic updates completed before the input
+    uint32_t timeMs;  // Simulation clock
+    InputSource source;
+    uint8_t index;
+    bool pressed;
+};
+
+struct InputTraceHeader {
+    uint16_t tickMs;        // Game update interval of the recording
+    uint32_t rainState;     // Rain generator state when the trace began
+    uint32_t startFrame;    // Frame the trace began at
+    uint32_t startTimeMs;   // Simulation clock when it began
+    uint32_t eventCount;
+    uint32_t droppedCount;  // Oldest events lost when the ring wrapped
+};
+
+// RAM ring of the inputs GameLogic received since the trace began, oldest
+// dropped first. GameLogic begins a new trace with each game, so a replay
+// starts from the press that started the round. Written and dumped from the
+// game task only.
+//
+// Binary format, little-endian: a 28-byte header ("ITRC", version u16,
+// tickMs u16, rainState u32, startFrame u32, startTimeMs u32, eventCount
+// u32, droppedCount u32) followed by 11-byte events (frame u32, timeMs u32, source u8, index
+// u8, pressed u8). Over
+// serial the bytes go out as hex between "TRACE BEGIN" and "TRACE END" lines,
+// which sim/trace_replay extracts from a capture.
+class InputTrace {
+public:
+    static constexpr uint16_t CAPACITY = GameConfig::Diagnostics::INPUT_TRACE_CAPACITY;
+    static constexpr uint32_t MAGIC = 0x43525449;  // "ITRC"
+    static constexpr uint16_t VERSION = 2;
+    static constexpr size_t HEADER_SIZE = 28;
+    static constexpr size_t EVENT_SIZE = 11;
+
+    InputTrace();
+
+    // Empties the ring and starts a trace at `frame` and `timeMs`, with the
+    // rain generator in `rainState`.
+    void begin(uint32_t frame, uint32_t timeMs, uint32_t rainState);
+    void record(const InputEvent& event);
+    uint16_t size() const { return count; }
+    const InputEvent& at(uint16_t i) const;  // Oldest first
+    InputTraceHeader header(uint16_t tickMs) const;
+
+    // Blocks the caller for as long as the stream takes, about a second for
+    // a full ring at 115200 baud.
+    void dump(Stream& stream, uint16_t tickMs) const;
+
+    static void encodeHeader(uint8_t* out, const InputTraceHeader& header);
+    static bool decodeHeader(const uint8_t* in, InputTraceHeader& header);
+    static void encodeEvent(uint8_t* out, const InputEvent& event);
+    static InputEvent decodeEvent(const uint8_t* in);
+
+private:
+    InputEvent events[CAPACITY];
+    uint16_t head;  // Next slot to write
+    uint16_t count;
+    uint32_t startFrame;
+    uint32_t startTimeMs;
+    uint32_t rainState;
+    uint32_t dropped;
+};
+
+// Feeds recorded inputs back into a GameLogic, each before the update it was
+// recorded before. Inputs recorded at or before the previous update's time
+// go in ahead of that frame's clock advance, the rest after it.
+class InputReplay {
+public:
+    InputReplay(const InputEvent* events, uint32_t count, uint32_t startFrame);
+
+    // `frame` counts updates since the replay began.
+    void applyBeforeAdvance(uint32_t frame, uint32_t nowMs, GameLogic& game);
+    void applyAfterAdvance(uint32_t frame, GameLogic& game);
+    bool isDone() const { return next >= count; }
+
+private:
+    void apply(const InputEvent& event, GameLogic& game);
+
+    const InputEvent* events;
+    uint32_t count;
+    uint32_t startFrame;
+    uint32_t next;
+};
@@ -7,29 +7,150 @@ enum class MatrixOrientation {
     TOP_LEFT_VERTICAL,
     BOTTOM_LEFT_HORIZONTAL,
     BOTTOM_LEFT_VERTICAL,
-    BOTTOM_RIGHT_VERTICAL 
+    BOTTOM_RIGHT_VERTICAL
 };
 
+struct MatrixCoord {
+    uint8_t x;
+    uint8_t y;
+};
+
+const char* orientationToString(MatrixOrientation o);
+
+// Matrix layout resolved at compile time. XY() becomes a single table lookup;
+// the orientation switch only runs while the tables are being generated.
+template <uint8_t W, uint8_t H, MatrixOrientation Orientation, bool Zigzag>
 class MatrixConfig {
 public:
-    MatrixConfig(uint8_t width, uint8_t height, MatrixOrientation orientation, bool zigzag);
-    
-    uint8_t getWidth() const;
-    uint8_t getHeight() const;
-    MatrixOrientation getOrientation() const;
-    bool isZigzag() const;
-    uint16_t getNumLeds() const;
-    
-    uint16_t XY(uint8_t x, uint8_t y) const;
-    void validate() const;
+    static constexpr uint8_t WIDTH = W;
+    static constexpr uint8_t HEIGHT = H;
+    static constexpr uint16_t LED_COUNT = static_cast<uint16_t>(W) * H;
+
+    static_assert(W > 0 && H > 0, "Invalid matrix dimensions");
+    static_assert(LED_COUNT <= 1024, "Matrix size exceeds MAX_LEDS"); // Adjust as needed
+
+    MatrixConfig() {
+        LOG_INFO("MatrixConfig created: %dx%d, %s, %s",
+                 W, H,
+                 orientationToString(Orientation),
+                 Zigzag ? "zigzag" : "normal");
+    }
+
+    uint8_t getWidth() const { return W; }
+    uint8_t getHeight() const { return H; }
+    MatrixOrientation getOrientation() const { return Orientation; }
+    bool isZigzag() const { return Zigzag; }
+    uint16_t getNumLeds() const { return LED_COUNT; }
+
+    // Checked accessor: logs and falls back to the first LED when out of range.
+    uint16_t XY(uint8_t x, uint8_t y) const {
+        if (x >= W || y >= H) {
+            LOG_ERROR("Invalid coordinates: (%u, %u)", static_cast<unsigned int>(x), static_cast<unsigned int>(y));
+            return 0;
+        }
+        return tables.index[y * W + x];
+    }
+
+    // Unchecked accessors for render loops that already iterate within bounds.
+    static constexpr uint16_t XYUnchecked(uint8_t x, uint8_t y) {
+        return tables.index[y * W + x];
+    }
+
+    static constexpr uint16_t XYUnchecked(uint16_t pixelIndex) {
+        return tables.index[pixelIndex];
+    }
+
+    static constexpr MatrixCoord coordOf(uint16_t ledIndex) {
+        return tables.coord[ledIndex];
+    }
+
+    // Column spans: when COLUMN_CONTIGUOUS, every column is one run of
+    // consecutive LEDs and the LED of (x, y) is columnBase(x) + y * columnStep(x).
+    static constexpr uint16_t columnBase(uint8_t x) {
+        return tables.index[x];
+    }
+
+    static constexpr int16_t columnStep(uint8_t x) {
+        return H > 1 ? static_cast<int16_t>(tables.index[W + x] - tables.index[x]) : 1;
+    }
 
 private:
-    uint8_t width;
-    uint8_t height;
-    MatrixOrientation orientation;
-    bool zigzag;
+    struct Tables {
+        uint16_t index[LED_COUNT];     // row-major pixel -> LED index
+        MatrixCoord coord[LED_COUNT];  // LED index -> (x, y)
+    };
+
+    static constexpr uint16_t computeXY(uint8_t x, uint8_t y) {
+        uint16_t i = 0;
+        switch (Orientation) {
+            case MatrixOrientation::TOP_LEFT_HORIZONTAL:
+                if (Zigzag && y % 2 == 1) {
+                    x = (W - 1) - x;
+                }
+                i = (y * W) + x;
+                break;
+            case MatrixOrientation::TOP_LEFT_VERTICAL:
+                if (Zigzag && x % 2 == 1) {
+                    y = (H - 1) - y;
+                }
+                i = (x * H) + y;
+                break;
+            case MatrixOrientation::BOTTOM_LEFT_HORIZONTAL:
+                y = (H - 1) - y;
+                if (Zigzag && y % 2 == 1) {
+                    x = (W - 1) - x;
+                }
+                i = (y * W) + x;
+                break;
+            case MatrixOrientation::BOTTOM_LEFT_VERTICAL:
+                // Reverse x to start from bottom-left
+                x = (W - 1) - x;
+                // If zigzag, alternate the direction of y for odd columns
+                if (Zigzag && x % 2 == 0) {
+                    y = (H - 1) - y;
+                }
+                i = (x * H) + y;
+                break;
+            case MatrixOrientation::BOTTOM_RIGHT_VERTICAL:
+                y = (H - 1) - y;
+                if (Zigzag && x % 2 == 1) {
+                    y = (H - 1) - y;
+                }
+                i = (x * H) + y;
+                break;
+        }
+        return i;
+    }
 
-    static constexpr uint16_t MAX_LEDS = 1024; // Adjust as needed
+    static constexpr Tables buildTables() {
+        Tables t{};
+        for (uint8_t y = 0; y < H; y++) {
+            for (uint8_t x = 0; x < W; x++) {
+                uint16_t i = computeXY(x, y);
+                t.index[y * W + x] = i;
+                t.coord[i] = MatrixCoord{x, y};
+            }
+        }
+        return t;
+    }
 
-    static const char* orientationToString(MatrixOrientation o);
-};
\ No newline at end of file
+    static constexpr Tables tables = buildTables();
+
+    static constexpr bool columnsContiguous() {
+        for (uint8_t x = 0; x < W; x++) {
+            int16_t step = H > 1 ? static_cast<int16_t>(computeXY(x, 1) - computeXY(x, 0)) : 1;
+            if (step != 1 && step != -1) {
+                return false;
+            }
+            for (uint8_t y = 0; y < H; y++) {
+                if (computeXY(x, y) != computeXY(x, 0) + y * step) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+public:
+    static constexpr bool COLUMN_CONTIGUOUS = columnsContiguous();
+};
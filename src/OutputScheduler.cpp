@@ -0,0 +1,125 @@
+#include "OutputScheduler.h"
+#include "DebugLogger.h"
+
+OutputScheduler::Output OutputScheduler::s_outputs[STRIP_COUNT] = {};
+uint64_t OutputScheduler::s_totalWireUs = 0;
+std::atomic<uint32_t> OutputScheduler::s_frameCount(0);
+std::atomic<uint32_t> OutputScheduler::s_lastWireUs(0);
+std::atomic<uint32_t> OutputScheduler::s_averageWireUs(0);
+std::atomic<uint32_t> OutputScheduler::s_maxWireUs(0);
+
+void OutputScheduler::attach(LedStrip strip, CLEDController& controller) {
+    Output& output = s_outputs[static_cast<uint8_t>(strip)];
+    output.controller = &controller;
+    output.dirty = true;  // First frame pushes everything
+    LOG_DEBUG("Output strip %s attached", getStripName(strip));
+}
+
+void OutputScheduler::markDirty(LedStrip strip) {
+    s_outputs[static_cast<uint8_t>(strip)].dirty = true;
+}
+
+bool OutputScheduler::show() {
+    bool anyDirty = false;
+    for (const Output& output : s_outputs) {
+        anyDirty |= output.dirty && output.controller;
+    }
+    if (!anyDirty) {
+        return false;
+    }
+
+    uint8_t brightness = FastLED.getBrightness();
+    uint32_t start = micros();
+    for (Output& output : s_outputs) {
+        if (!output.controller || !(output.dirty || SHOWS_ALL_STRIPS)) {
+            continue;
+        }
+        uint32_t stripStart = micros();
+        output.controller->showLeds(brightness);
+        output.dirty = false;
+        if (!SHOWS_ALL_STRIPS) {
+            recordWire(output, micros() - stripStart);
+        }
+        output.showCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    uint32_t wireUs = micros() - start;
+
+    uint32_t frames = s_frameCount.load(std::memory_order_relaxed) + 1;
+    s_totalWireUs += wireUs;
+    s_lastWireUs.store(wireUs, std::memory_order_relaxed);
+    s_averageWireUs.store(static_cast<uint32_t>(s_totalWireUs / frames), std::memory_order_relaxed);
+    if (wireUs > s_maxWireUs.load(std::memory_order_relaxed)) {
+        s_maxWireUs.store(wireUs, std::memory_order_relaxed);
+    }
+    s_frameCount.store(frames, std::memory_order_relaxed);
+    return true;
+}
+
+// Called before showCount counts this push.
+void OutputScheduler::recordWire(Output& output, uint32_t wireUs) {
+    uint32_t shows = output.showCount.load(std::memory_order_relaxed) + 1;
+    output.totalWireUs += wireUs;
+    output.lastWireUs.store(wireUs, std::memory_order_relaxed);
+    output.averageWireUs.store(static_cast<uint32_t>(output.totalWireUs / shows), std::memory_order_relaxed);
+    if (wireUs > output.maxWireUs.load(std::memory_order_relaxed)) {
+        output.maxWireUs.store(wireUs, std::memory_order_relaxed);
+    }
+}
+
+uint32_t OutputScheduler::getShowCount(LedStrip strip) {
+    return s_outputs[static_cast<uint8_t>(strip)].showCount.load(std::memory_order_relaxed);
+}
+
+uint32_t OutputScheduler::getStripLastWireUs(LedStrip strip) {
+    return s_outputs[static_cast<uint8_t>(strip)].lastWireUs.load(std::memory_order_relaxed);
+}
+
+uint32_t OutputScheduler::getStripAverageWireUs(LedStrip strip) {
+    return s_outputs[static_cast<uint8_t>(strip)].averageWireUs.load(std::memory_order_relaxed);
+}
+
+uint32_t OutputScheduler::getStripMaxWireUs(LedStrip strip) {
+    return s_outputs[static_cast<uint8_t>(strip)].maxWireUs.load(std::memory_order_relaxed);
+}
+
+uint32_t OutputScheduler::getFrameCount() {
+    return s_frameCount.load(std::memory_order_relaxed);
+}
+
+uint32_t OutputScheduler::getLastWireUs() {
+    return s_lastWireUs.load(std::memory_order_relaxed);
+}
+
+uint32_t OutputScheduler::getAverageWireUs() {
+    return s_averageWireUs.load(std::memory_order_relaxed);
+}
+
+uint32_t OutputScheduler::getMaxWireUs() {
+    return s_maxWireUs.load(std::memory_order_relaxed);
+}
+
+const char* OutputScheduler::getStripName(LedStrip strip) {
+    switch (strip) {
+        case LedStrip::MATRIX: return "MATRIX";
+        case LedStrip::SECONDARY: return "SECONDARY";
+        default: return "UNKNOWN";
+    }
+}
+
+void OutputScheduler::logStats() {
+    for (uint8_t i = 0; i < STRIP_COUNT; i++) {
+        LedStrip strip = static_cast<LedStrip>(i);
+        if (SHOWS_ALL_STRIPS) {
+            LOG_INFO("%s strip: %lu shows", getStripName(strip), static_cast<unsigned long>(getShowCount(strip)));
+        } else {
+            LOG_INFO("%s strip: %lu shows, wire time last %lu us, avg %lu us, max %lu us", getStripName(strip),
+                     static_cast<unsigned long>(getShowCount(strip)),
+                     static_cast<unsigned long>(getStripLastWireUs(strip)),
+                     static_cast<unsigned long>(getStripAverageWireUs(strip)),
+                     static_cast<unsigned long>(getStripMaxWireUs(strip)));
+        }
+    }
+    LOG_INFO("Output frames: %lu, wire time last %lu us, avg %lu us, max %lu us",
+             static_cast<unsigned long>(getFrameCount()), static_cast<unsigned long>(getLastWireUs()),
+             static_cast<unsigned long>(getAverageWireUs()), static_cast<unsigned long>(getMaxWireUs()));
+}
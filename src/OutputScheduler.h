@@ -0,0 +1,74 @@
+#pragma once
+#include <Arduino.h>
+#include <FastLED.h>
+#include <atomic>
+
+enum class LedStrip : uint8_t {
+    MATRIX,
+    SECONDARY,
+    COUNT
+};
+
+// Pushes the LED strips through their own controllers, at most once per
+// frame and only when a strip changed. On drivers that send each controller
+// as it is shown, only the dirty strips go out and each strip's wire time is
+// tracked.
+//
+// FastLED 3.7.0's ESP32 RMT driver only transmits once every registered
+// controller has called showLeds() for the frame, and then sends all strips
+// together. Showing only the dirty strip would send nothing, or send it a
+// frame late next to the other strip's old data. On ESP32 every attached
+// strip therefore goes out whenever any of them changed, which is no less
+// wire time than one FastLED.show() per changed frame, and only the frame's
+// wire time can be measured.
+//
+// attach(), markDirty() and show() belong to the LED task; the stats can be
+// read from any task. Frame wire time is the time show() spends in
+// showLeds() for the whole frame.
+class OutputScheduler {
+public:
+#if defined(ARDUINO_ARCH_ESP32)
+    static constexpr bool SHOWS_ALL_STRIPS = true;
+#else
+    static constexpr bool SHOWS_ALL_STRIPS = false;
+#endif
+
+    static void attach(LedStrip strip, CLEDController& controller);
+    static void markDirty(LedStrip strip);
+    // Shows the strips for this frame; returns true when any was pushed.
+    static bool show();
+
+    static uint32_t getShowCount(LedStrip strip);
+    // Per strip wire time; stays 0 on batching drivers.
+    static uint32_t getStripLastWireUs(LedStrip strip);
+    static uint32_t getStripAverageWireUs(LedStrip strip);
+    static uint32_t getStripMaxWireUs(LedStrip strip);
+    static uint32_t getFrameCount();  // Frames with at least one push
+    static uint32_t getLastWireUs();
+    static uint32_t getAverageWireUs();
+    static uint32_t getMaxWireUs();
+    static const char* getStripName(LedStrip strip);
+    static void logStats();
+
+private:
+    static constexpr uint8_t STRIP_COUNT = static_cast<uint8_t>(LedStrip::COUNT);
+
+    struct Output {
+        CLEDController* controller;
+        bool dirty;
+        std::atomic<uint32_t> showCount;
+        uint64_t totalWireUs;  // LED task only
+        std::atomic<uint32_t> lastWireUs;
+        std::atomic<uint32_t> averageWireUs;
+        std::atomic<uint32_t> maxWireUs;
+    };
+
+    static void recordWire(Output& output, uint32_t wireUs);
+
+    static Output s_outputs[STRIP_COUNT];
+    static uint64_t s_totalWireUs;  // LED task only
+    static std::atomic<uint32_t> s_frameCount;
+    static std::atomic<uint32_t> s_lastWireUs;
+    static std::atomic<uint32_t> s_averageWireUs;
+    static std::atomic<uint32_t> s_maxWireUs;
+};
@@ -0,0 +1,145 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+enum class PixelType : uint8_t {
+    ACTIVE,
+    BUILDING,
+    SEWER,
+    BASIN,
+    GIEP_1,
+    GIEP_2,
+    GIEP_3,
+    GIEP_4,
+    GIEP_5,
+    GIEP_6,
+    GIEP_7,
+    GIEP_8,
+    BASIN_GATE,
+    BASIN_OVERFLOW,
+    RIVER
+};
+
+// Pixel map stored as packed bitplanes, one bit per pixel in row-major order.
+// Four planes hold the bits of each pixel's PixelType; a fifth duplicates the
+// building cells so building queries read a single plane. A type mask costs
+// four word operations per 64 pixels.
+template <uint8_t W, uint8_t H>
+class PixelBitboard {
+public:
+    static constexpr uint16_t PIXEL_COUNT = static_cast<uint16_t>(W) * H;
+    static constexpr uint8_t WORDS = (PIXEL_COUNT + 63) / 64;
+    static constexpr uint8_t TYPE_BITS = 4;
+
+    static_assert(W <= 32, "Row masks are 32 bits wide");
+    static_assert(static_cast<int>(PixelType::RIVER) < (1 << TYPE_BITS), "PixelType does not fit the type planes");
+
+    // One bit per pixel, same layout as the board.
+    struct Plane {
+        uint64_t words[WORDS];
+
+        bool test(uint16_t i) const { return (words[i >> 6] >> (i & 63)) & 1; }
+        Plane operator|(const Plane& other) const {
+            Plane result;
+            for (uint8_t w = 0; w < WORDS; w++) result.words[w] = words[w] | other.words[w];
+            return result;
+        }
+        Plane operator&(const Plane& other) const {
+            Plane result;
+            for (uint8_t w = 0; w < WORDS; w++) result.words[w] = words[w] & other.words[w];
+            return result;
+        }
+        uint16_t count() const {
+            uint16_t total = 0;
+            for (uint8_t w = 0; w < WORDS; w++) total += __builtin_popcountll(words[w]);
+            return total;
+        }
+    };
+
+    PixelBitboard() { clear(); }
+
+    // Resets every pixel to ACTIVE.
+    void clear() {
+        memset(typePlanes, 0, sizeof(typePlanes));
+        memset(&buildings, 0, sizeof(buildings));
+    }
+
+    void set(uint16_t i, PixelType type) {
+        uint8_t code = static_cast<uint8_t>(type);
+        for (uint8_t b = 0; b < TYPE_BITS; b++) {
+            assign(typePlanes[b], i, (code >> b) & 1);
+        }
+        assign(buildings, i, type == PixelType::BUILDING);
+    }
+
+    PixelType typeAt(uint16_t i) const {
+        uint8_t code = 0;
+        for (uint8_t b = 0; b < TYPE_BITS; b++) {
+            code |= static_cast<uint8_t>(typePlanes[b].test(i)) << b;
+        }
+        return static_cast<PixelType>(code);
+    }
+
+    bool isBuilding(uint16_t i) const { return buildings.test(i); }
+
+    const Plane& buildingMask() const { return buildings; }
+
+    // All pixels of one type.
+    Plane mask(PixelType type) const {
+        uint8_t code = static_cast<uint8_t>(type);
+        Plane result;
+        for (uint8_t w = 0; w < WORDS; w++) {
+            uint64_t match = ~0ULL;
+            for (uint8_t b = 0; b < TYPE_BITS; b++) {
+                match &= ((code >> b) & 1) ? typePlanes[b].words[w] : ~typePlanes[b].words[w];
+            }
+            result.words[w] = match;
+        }
+        clearPadding(result);
+        return result;
+    }
+
+    // GIEP_1..GIEP_8 are codes 0b01xx and 0b10xx, i.e. bit 2 xor bit 3.
+    Plane giepMask() const {
+        Plane result;
+        for (uint8_t w = 0; w < WORDS; w++) {
+            result.words[w] = typePlanes[2].words[w] ^ typePlanes[3].words[w];
+        }
+        return result;
+    }
+
+    // Bit x of the result is set when (x, y) is a building.
+    uint32_t buildingRow(uint8_t y) const { return rowOf(buildings, y); }
+
+    static uint32_t rowOf(const Plane& plane, uint8_t y) {
+        uint16_t offset = static_cast<uint16_t>(y) * W;
+        uint8_t word = offset >> 6;
+        uint8_t shift = offset & 63;
+        uint64_t bits = plane.words[word] >> shift;
+        if (shift + W > 64) {
+            bits |= plane.words[word + 1] << (64 - shift);
+        }
+        return static_cast<uint32_t>(bits) & ROW_MASK;
+    }
+
+private:
+    static constexpr uint32_t ROW_MASK = W == 32 ? 0xFFFFFFFFu : ((1u << W) - 1);
+
+    static void assign(Plane& plane, uint16_t i, bool value) {
+        uint64_t bit = 1ULL << (i & 63);
+        if (value) {
+            plane.words[i >> 6] |= bit;
+        } else {
+            plane.words[i >> 6] &= ~bit;
+        }
+    }
+
+    static void clearPadding(Plane& plane) {
+        if (PIXEL_COUNT % 64) {
+            plane.words[WORDS - 1] &= (1ULL << (PIXEL_COUNT % 64)) - 1;
+        }
+    }
+
+    Plane typePlanes[TYPE_BITS];
+    Plane buildings;
+};
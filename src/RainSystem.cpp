@@ -3,24 +3,104 @@
 
 using namespace GameConfig;
 
-RainSystem::RainSystem(const MatrixConfig& config)
-    : matrixConfig(config), width(config.getWidth()), height(config.getHeight()),
+RainSystem::RainSystem(const MainMatrixConfig& config, XorShiftRandom& rng)
+    : matrixConfig(config), rng(rng), dropCount(0), width(config.getWidth()), height(config.getHeight()),
       intensity(0), isVisible(true), mode(RainMode::NORMAL) {
+#ifdef SURFACE_WATER_GRID
+    runoff = nullptr;
+#endif
+    for (auto& column : surfaces) {
+        column.count = 0;
+    }
+    impactCounters.fill(0);
     initializeRain();
+    for (uint8_t m = 0; m < RAIN_MODE_COUNT; m++) {
+        buildBrightnessTables(static_cast<RainMode>(m));
+    }
 }
 
-void RainSystem::initializeRain() {
-    for (uint8_t x = 0; x < width; x++) {
-        rainDrops[x] = {height, 0}; // Start with no raindrops and no trail
+void RainSystem::setSurfaces(const RainSurfaceTable& table) {
+    surfaces = table;
+    for (uint16_t i = 0; i < dropCount; i++) {
+        resolveStop(i);
     }
 }
 
-void RainSystem::update(const bool* buildingMap) {
-    if (!isVisible) {
-        for (uint8_t x = 0; x < width; x++) {
-            rainDrops[x] = {height, 0};
+RainZone RainSystem::zoneFor(PixelType type) {
+    switch (type) {
+        case PixelType::BUILDING:
+        case PixelType::SEWER:
+            return RainZone::SEWER;
+        case PixelType::BASIN:
+            return RainZone::BASIN;
+        default:
+            if (type >= PixelType::GIEP_1 && type <= PixelType::GIEP_8) {
+                return static_cast<RainZone>(static_cast<uint8_t>(RainZone::GIEP_1) +
+                                             static_cast<uint8_t>(type) - static_cast<uint8_t>(PixelType::GIEP_1));
+            }
+            return RainZone::NONE;
+    }
+}
+
+// Finds the first surface below drop i, or the bottom edge when it falls off the matrix.
+void RainSystem::resolveStop(uint16_t i) {
+    const ColumnSurfaces& column = surfaces[dropX[i]];
+    uint8_t y = dropY[i];
+    for (uint8_t r = 0; r < column.count; r++) {
+        if (column.runs[r].bottom > y) {
+            dropStop[i] = std::max<uint8_t>(column.runs[r].top, y + 1);
+            dropZone[i] = zoneFor(column.runs[r].type);
+            return;
         }
-        return;
+    }
+    dropStop[i] = height;
+    dropZone[i] = RainZone::NONE;
+}
+
+RainImpacts RainSystem::takeImpacts() {
+    RainImpacts impacts;
+    for (uint8_t zone = 0; zone < RAIN_ZONE_COUNT; zone++) {
+        impacts.counts[zone] = impactCounters[zone];
+    }
+    impactCounters.fill(0);
+    return impacts;
+}
+
+void RainSystem::reset() {
+    initializeRain();
+    impactCounters.fill(0);
+}
+
+void RainSystem::initializeRain() {
+    dropCount = 0; // Start with no raindrops
+    columnSpawnAge.fill(RainVisuals::RAIN_MIN_DROP_SPACING);
+}
+
+void RainSystem::spawnDrop(uint8_t x) {
+    dropX[dropCount] = x;
+    dropY[dropCount] = 0; // New raindrop at the top with no trail
+    dropTrail[dropCount] = 0;
+    resolveStop(dropCount);
+    dropCount++;
+    columnSpawnAge[x] = 0;
+}
+
+// Swap-remove: the last live drop takes the freed slot.
+void RainSystem::removeDrop(uint16_t i) {
+    dropCount--;
+    dropX[i] = dropX[dropCount];
+    dropY[i] = dropY[dropCount];
+    dropTrail[i] = dropTrail[dropCount];
+    dropStop[i] = dropStop[dropCount];
+    dropZone[i] = dropZone[dropCount];
+}
+
+bool RainSystem::update() {
+    bool changed = false;
+    if (!isVisible) {
+        changed = dropCount > 0;
+        initializeRain();
+        return changed;
     }
 
     float dropChance = intensity;
@@ -35,42 +115,66 @@ void RainSystem::update(const bool* buildingMap) {
         case RainMode::STORM:
             dropChance *= RainVisuals::RAIN_STORM_MULTIPLIER;
             maxTrailLength = RAIN_MAX_TRAIL_LENGTH * 3;
-            windOffset = random8(3) - 1; // -1, 0, or 1
+            windOffset = rng.next8(3) - 1; // -1, 0, or 1
             break;
         default:
             break;
     }
 
-    for (uint8_t x = 0; x < width; x++) {
-        if (rainDrops[x].y < height) {
-            uint16_t nextIndex = (rainDrops[x].y + 1) * width + x;
-            if (rainDrops[x].y + 1 < height && buildingMap[nextIndex]) {
-                // If the next position is a building, make the raindrop disappear
-                rainDrops[x] = {height, 0};
-            } else {
-                rainDrops[x].y++;
-                rainDrops[x].trailLength = std::min<uint8_t>(rainDrops[x].trailLength + 1, maxTrailLength);
-
-                if (mode == RainMode::STORM && random8() < RainVisuals::RAIN_STORM_WIND_CHANCE) {
-                    int8_t newX = (x + windOffset + width) % width;
-                    if (rainDrops[newX].y >= height) {
-                        std::swap(rainDrops[x], rainDrops[newX]);
-                    }
-                }
+    // Impacts are counted locally and added to the totals once per step
+    uint16_t impacts[RAIN_ZONE_COUNT + 1] = {};
+
+    changed = dropCount > 0;
+    uint16_t i = 0;
+    while (i < dropCount) {
+        uint8_t x = dropX[i];
+        uint8_t y = dropY[i];
+        if (y + 1 >= dropStop[i]) {
+            // Landed on a surface or left the matrix
+            impacts[static_cast<uint8_t>(dropZone[i])]++;
+#ifdef SURFACE_WATER_GRID
+            if (runoff) {
+                runoff->addWater(x, y, SurfaceWater::DROP_DEPTH);
             }
+#endif
+            removeDrop(i);
+            continue;
         }
-        
-        if (rainDrops[x].y >= height && random8() < dropChance * 255) {
-            rainDrops[x] = {0, 0}; // New raindrop at the top with no trail
+        dropY[i] = y + 1;
+        dropTrail[i] = std::min<uint8_t>(dropTrail[i] + 1, maxTrailLength);
+
+        if (mode == RainMode::STORM && rng.next8() < RainVisuals::RAIN_STORM_WIND_CHANCE) {
+            uint8_t newX = (x + windOffset + width) % width;
+            dropX[i] = newX;
+            resolveStop(i);
         }
+        i++;
     }
-}
 
-void RainSystem::draw(CRGB* leds) const {
-    if (!isVisible) return;
+    // A column may hold several drops, spaced at least RAIN_MIN_DROP_SPACING rows apart
+    static_assert(MAX_DROPS >= MATRIX_WIDTH * ((MATRIX_HEIGHT + RainVisuals::RAIN_MIN_DROP_SPACING) /
+                                               (RainVisuals::RAIN_MIN_DROP_SPACING + 1)),
+                  "The drop pool must hold every drop the spawn spacing allows");
+    for (uint8_t x = 0; x < width; x++) {
+        if (columnSpawnAge[x] < RainVisuals::RAIN_MIN_DROP_SPACING) {
+            columnSpawnAge[x]++;
+            continue;
+        }
+        if (dropCount < MAX_DROPS && rng.next8() < dropChance * 255) {
+            spawnDrop(x);
+            changed = true;
+        }
+    }
+
+    for (uint8_t zone = 0; zone < RAIN_ZONE_COUNT; zone++) {
+        impactCounters[zone] += impacts[zone];
+    }
+    return changed;
+}
 
+void RainSystem::buildBrightnessTables(RainMode tableMode) {
     uint8_t rainBrightness = std::min(static_cast<uint8_t>(Brightness::RAIN_BRIGHTNESS), static_cast<uint8_t>(255));
-    switch (mode) {
+    switch (tableMode) {
         case RainMode::HEAVY:
             rainBrightness = std::min(static_cast<uint8_t>(Brightness::RAIN_BRIGHTNESS * 1.5), static_cast<uint8_t>(255));
             break;
@@ -81,14 +185,50 @@ void RainSystem::draw(CRGB* leds) const {
             break;
     }
 
-    for (uint8_t x = 0; x < width; x++) {
-        for (uint8_t y = 0; y < height; y++) {
-            uint16_t index = matrixConfig.XY(x, y);
-            if (rainDrops[x].y == y) {
-                leds[index] = blend(leds[index], CRGB(0, 0, rainBrightness), 128);
-            } else if (y < rainDrops[x].y && y >= rainDrops[x].y - rainDrops[x].trailLength) {
-                uint8_t trailBrightness = map(rainDrops[x].y - y, 0, rainDrops[x].trailLength, rainBrightness, 0);
-                leds[index] = blend(leds[index], CRGB(0, 0, trailBrightness), 64);
+    uint8_t m = static_cast<uint8_t>(tableMode);
+    headBrightness[m] = rainBrightness;
+    for (uint8_t length = 0; length <= MAX_TRAIL; length++) {
+        for (uint8_t distance = 0; distance <= MAX_TRAIL; distance++) {
+            trailBrightness[m][length][distance] = length ? map(distance, 0, length, rainBrightness, 0) : rainBrightness;
+        }
+    }
+}
+
+// Hidden rain is captured as no drops.
+void RainSystem::capture(RainFrame& frame) const {
+    frame.count = isVisible ? dropCount : 0;
+    frame.mode = mode;
+    memcpy(frame.x, dropX.data(), frame.count);
+    memcpy(frame.y, dropY.data(), frame.count);
+    memcpy(frame.trail, dropTrail.data(), frame.count);
+}
+
+// Only the head and trail span of each drop is touched. On column-contiguous
+// layouts the span is walked directly through the column's LED run.
+void RainSystem::draw(const RainFrame& frame, CRGB* leds) const {
+    uint8_t m = static_cast<uint8_t>(frame.mode);
+    const CRGB headColor(0, 0, headBrightness[m]);
+    for (uint16_t i = 0; i < frame.count; i++) {
+        uint8_t x = frame.x[i];
+        uint8_t headY = frame.y[i];
+        uint8_t trailLength = frame.trail[i];
+        uint8_t span = std::min(trailLength, headY);
+        const uint8_t* brightness = trailBrightness[m][trailLength];
+
+        if constexpr (MainMatrixConfig::COLUMN_CONTIGUOUS) {
+            int16_t step = MainMatrixConfig::columnStep(x);
+            CRGB* led = leds + MainMatrixConfig::columnBase(x) + headY * step;
+            *led = blend(*led, headColor, 128);
+            for (uint8_t distance = 1; distance <= span; distance++) {
+                led -= step;
+                *led = blend(*led, CRGB(0, 0, brightness[distance]), 64);
+            }
+        } else {
+            uint16_t index = matrixConfig.XYUnchecked(x, headY);
+            leds[index] = blend(leds[index], headColor, 128);
+            for (uint8_t distance = 1; distance <= span; distance++) {
+                index = matrixConfig.XYUnchecked(x, headY - distance);
+                leds[index] = blend(leds[index], CRGB(0, 0, brightness[distance]), 64);
             }
         }
     }
@@ -108,4 +248,14 @@ void RainSystem::setVisible(bool visible) {
 
 void RainSystem::setMode(RainMode newMode) {
     mode = newMode;
-}
\ No newline at end of file
+}
+
+uint16_t RainSystem::getDropCount() const {
+    return dropCount;
+}
+
+#ifdef SURFACE_WATER_GRID
+void RainSystem::setRunoff(SceneSurfaceWater* grid) {
+    runoff = grid;
+}
+#endif
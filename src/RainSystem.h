@@ -6,6 +6,7 @@
 #include "MatrixConfig.h"
 #include "game_config.h"
 #include "config.h"
+#include "XorShiftRandom.h"
 
 enum class RainMode {
     NORMAL,
@@ -13,21 +14,93 @@ enum class RainMode {
     STORM
 };
 
-struct RainDrop {
-    uint8_t y;
-    uint8_t trailLength;
+constexpr uint8_t RAIN_MODE_COUNT = 3;
+
+// A vertical run of cells in one column that stops rain: roof, GIEP, sewer or basin.
+struct RainSurface {
+    uint8_t top;
+    uint8_t bottom;
+    PixelType type;
+};
+
+struct ColumnSurfaces {
+    // Adjacent cells of different types start separate runs, so every row
+    // of a column can be a run of its own.
+    static constexpr uint8_t MAX_RUNS = MATRIX_HEIGHT;
+    uint8_t count;
+    RainSurface runs[MAX_RUNS];  // Top to bottom
+};
+
+using RainSurfaceTable = std::array<ColumnSurfaces, MATRIX_WIDTH>;
+
+// Where landed water goes. Roofs drain into the sewer catchment.
+enum class RainZone : uint8_t {
+    SEWER,
+    BASIN,
+    GIEP_1,
+    GIEP_2,
+    GIEP_3,
+    GIEP_4,
+    GIEP_5,
+    GIEP_6,
+    GIEP_7,
+    GIEP_8,
+    COUNT,
+    NONE = COUNT
 };
 
+constexpr uint8_t RAIN_ZONE_COUNT = static_cast<uint8_t>(RainZone::COUNT);
+
+struct RainImpacts {
+    uint16_t counts[RAIN_ZONE_COUNT];
+
+    uint16_t operator[](RainZone zone) const { return counts[static_cast<uint8_t>(zone)]; }
+};
+
+// The drops as draw() needs them, copied out after a step so that another
+// task can draw them.
+struct RainFrame {
+    // A column spawns at most once every RAIN_MIN_DROP_SPACING + 1 steps and a
+    // drop lives at most MATRIX_HEIGHT steps, which bounds the live drops.
+    static constexpr uint16_t MAX_DROPS =
+        MATRIX_WIDTH * ((MATRIX_HEIGHT + GameConfig::RainVisuals::RAIN_MIN_DROP_SPACING) /
+                        (GameConfig::RainVisuals::RAIN_MIN_DROP_SPACING + 1));
+
+    uint16_t count;
+    RainMode mode;
+    uint8_t x[MAX_DROPS];
+    uint8_t y[MAX_DROPS];
+    uint8_t trail[MAX_DROPS];
+};
+
+// update() and the setters run on the game task, one update() per fixed
+// simulation step. draw() reads only the frame it is given and tables built
+// at construction, so the LED task can draw while the game task steps.
 class RainSystem {
 public:
-    RainSystem(const MatrixConfig& config);
+    RainSystem(const MainMatrixConfig& config, XorShiftRandom& rng);
 
-    void update(const bool* buildingMap);
-    void draw(CRGB* leds) const;
+    // Advances the drops one fixed step. Returns true when any drop moved,
+    // appeared or vanished.
+    bool update();
+    // Surfaces come from the scene map and only change when the map does.
+    void setSurfaces(const RainSurfaceTable& table);
+    // Returns and clears the impacts counted since the last call.
+    RainImpacts takeImpacts();
+    // Drops every drop and every impact not yet taken.
+    void reset();
+    uint32_t getRandomState() const { return rng.getState(); }
+    void capture(RainFrame& frame) const;
+    void draw(const RainFrame& frame, CRGB* leds) const;
     void setIntensity(float intensity);
     float getIntensity() const;
     void setVisible(bool visible);
     void setMode(RainMode mode);
+    uint16_t getDropCount() const;
+#ifdef SURFACE_WATER_GRID
+    // Landed drops also leave water on the cell they stopped in.
+    void setRunoff(SceneSurfaceWater* grid);
+#endif
 
 private:
     static constexpr uint8_t RAIN_MAX_TRAIL_LENGTH = 4;
@@ -36,13 +109,38 @@ private:
     static constexpr uint8_t RAIN_STORM_WIND_CHANCE = 64; // 25% chance
     static constexpr uint8_t RAIN_BRIGHTNESS = 64;
 
-    const MatrixConfig& matrixConfig;
-    std::array<RainDrop, MATRIX_WIDTH> rainDrops;
+    static constexpr uint16_t MAX_DROPS = RainFrame::MAX_DROPS;
+    static constexpr uint8_t MAX_TRAIL = RAIN_MAX_TRAIL_LENGTH * 3;  // Storm trails are longest
+
+    const MainMatrixConfig& matrixConfig;
+    XorShiftRandom& rng;
+    // Drop pool in structure-of-arrays layout; live drops are [0, dropCount).
+    std::array<uint8_t, MAX_DROPS> dropX;
+    std::array<uint8_t, MAX_DROPS> dropY;
+    std::array<uint8_t, MAX_DROPS> dropTrail;
+    std::array<uint8_t, MAX_DROPS> dropStop;  // Row of the surface the drop will land on
+    std::array<RainZone, MAX_DROPS> dropZone; // Zone of that surface
+    uint16_t dropCount;
+    std::array<uint8_t, MATRIX_WIDTH> columnSpawnAge; // Frames since the column last spawned
+    // trailBrightness[mode][length][distance]: brightness of the trail cell
+    // `distance` rows above a head whose trail is `length` long.
+    uint8_t trailBrightness[RAIN_MODE_COUNT][MAX_TRAIL + 1][MAX_TRAIL + 1];
+    uint8_t headBrightness[RAIN_MODE_COUNT];
+    RainSurfaceTable surfaces;
+    std::array<uint16_t, RAIN_ZONE_COUNT> impactCounters;
     uint8_t width;
     uint8_t height;
     float intensity;
     bool isVisible;
     RainMode mode;
+#ifdef SURFACE_WATER_GRID
+    SceneSurfaceWater* runoff;
+#endif
 
     void initializeRain();
+    void spawnDrop(uint8_t x);
+    void removeDrop(uint16_t i);
+    void buildBrightnessTables(RainMode tableMode);
+    void resolveStop(uint16_t i);
+    static RainZone zoneFor(PixelType type);
 };
\ No newline at end of file
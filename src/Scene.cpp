@@ -1,105 +1,136 @@
 #include "Scene.h"
 #include "config.h"
-#include <stack>
+#include <algorithm>
 
 using namespace GameConfig;
 
-Scene::Scene(const MatrixConfig& config)
-    : matrixConfig(config), width(config.getWidth()), height(config.getHeight()),
-      sewerLevel(0), basinLevel(0), basinGateActive(false), isBasinOverflow(false),
-      riverFlowOffset(0), isPolluted(false), isFloodState(false), rainSystem(config) {
-    initializePixelMap();
-    initializeBuildingMap();
-    giepStates.fill(false);
+namespace {
+// Scratch space for detectShapes(). Static so that labeling never allocates.
+uint16_t regionLabels[NUM_LEDS];     // Per pixel, row-major; 0 = not part of a shape
+uint16_t labelParent[NUM_LEDS + 1];  // Union-find forest over provisional labels
+constexpr uint16_t NO_REGION = 0xFFFF;
+
+// Parents always point to a smaller label, so roots are the first label of a region.
+uint16_t findRoot(uint16_t label) {
+    while (labelParent[label] != label) {
+        labelParent[label] = labelParent[labelParent[label]];
+        label = labelParent[label];
+    }
+    return label;
+}
+
+constexpr RenderState INITIAL_RENDER_STATE = {
+    0, 0, GameBalance::LEVEL_EMPTY, GameBalance::LEVEL_EMPTY, 0, false, false, false, {}
+#ifdef SURFACE_WATER_GRID
+    , {}
+#endif
+};
+}
+
+Scene::Scene(const MainMatrixConfig& config, const SimClock& clock, XorShiftRandom& rng)
+    : matrixConfig(config), clock(clock), width(config.getWidth()), height(config.getHeight()),
+      published(INITIAL_RENDER_STATE), staged(INITIAL_RENDER_STATE), latest(INITIAL_RENDER_STATE),
+      current(INITIAL_RENDER_STATE), isBasinOverflow(false),
+      riverFlowOffset(0), dirty(true), lastBlinkPhase(0), rainSystem(config, rng) {
+    pending.sewerLevel.store(current.sewerLevel, std::memory_order_relaxed);
+    pending.basinLevel.store(current.basinLevel, std::memory_order_relaxed);
+    pending.rainIntensity.store(0.0f, std::memory_order_relaxed);
+    pending.rainMode.store(RainMode::NORMAL, std::memory_order_relaxed);
+    pending.giepMask.store(current.giepMask, std::memory_order_relaxed);
+    pending.basinGateActive.store(current.basinGateActive, std::memory_order_relaxed);
+    pending.polluted.store(current.polluted, std::memory_order_relaxed);
+    pending.flood.store(current.flood, std::memory_order_relaxed);
+    pending.rainVisible.store(true, std::memory_order_relaxed);
+#ifdef SURFACE_WATER_GRID
+    surfaceWater.setSinkRate(SceneSurfaceWater::SINK_SEWER, SurfaceWater::SEWER_INTAKE);
+    surfaceWater.setSinkRate(SceneSurfaceWater::SINK_BASIN, SurfaceWater::BASIN_INTAKE);
+    surfaceWater.setSinkRate(SceneSurfaceWater::SINK_SOAK, SurfaceWater::SOAK_RATE);
+    surfaceGiepMask = current.giepMask;
+    surfaceToSewer = 0;
+    surfaceToBasin = 0;
+    rainSystem.setRunoff(&surfaceWater);
+#endif
+    rebuildBackground();
 }
 
 Scene::~Scene() {
-    cleanupPixelMap();
-    cleanupBuildingMap();
 }
 
 void Scene::setFloodState(bool state) {
-    isFloodState = state;
-    DebugLogger::info("Flood state set to: %d", state);
+    pending.flood.store(state, std::memory_order_relaxed);
+    LOG_INFO("Flood state set to: %d", state);
 }
 
 void Scene::loadBitmap(const uint32_t* bitmap, uint8_t bitmapWidth, uint8_t bitmapHeight) {
     if (bitmapWidth != width || bitmapHeight != height) {
-        DebugLogger::error("Bitmap dimensions do not match matrix dimensions");
+        LOG_ERROR("Bitmap dimensions do not match matrix dimensions");
         return;
     }
 
     for (uint16_t i = 0; i < width * height; i++) {
         uint32_t color = bitmap[i];
+        PixelType type;
         switch (color) {
             case COLOR_WHITE:
-                pixelMap[i] = PixelType::ACTIVE;
-                buildingMap[i] = false;
+                type = PixelType::ACTIVE;
                 break;
             case COLOR_BLACK:
-                pixelMap[i] = PixelType::BUILDING;
-                buildingMap[i] = true;
+                type = PixelType::BUILDING;
                 break;
             case COLOR_YELLOW:
-                pixelMap[i] = PixelType::SEWER;
-                buildingMap[i] = false;
+                type = PixelType::SEWER;
                 break;
             case COLOR_BLUE:
-                pixelMap[i] = PixelType::BASIN;
-                buildingMap[i] = false;
+                type = PixelType::BASIN;
                 break;
             case COLOR_GREEN_1:
-                pixelMap[i] = PixelType::GIEP_1;
-                buildingMap[i] = false;
+                type = PixelType::GIEP_1;
                 break;
             case COLOR_GREEN_2:
-                pixelMap[i] = PixelType::GIEP_2;
-                buildingMap[i] = false;
+                type = PixelType::GIEP_2;
                 break;
             case COLOR_GREEN_3:
-                pixelMap[i] = PixelType::GIEP_3;
-                buildingMap[i] = false;
+                type = PixelType::GIEP_3;
                 break;
             case COLOR_GREEN_4:
-                pixelMap[i] = PixelType::GIEP_4;
-                buildingMap[i] = false;
+                type = PixelType::GIEP_4;
                 break;
             case COLOR_GREEN_5:
-                pixelMap[i] = PixelType::GIEP_5;
-                buildingMap[i] = false;
+                type = PixelType::GIEP_5;
                 break;
             case COLOR_GREEN_6:
-                pixelMap[i] = PixelType::GIEP_6;
-                buildingMap[i] = false;
+                type = PixelType::GIEP_6;
                 break;
             case COLOR_GREEN_7:
-                pixelMap[i] = PixelType::GIEP_7;
-                buildingMap[i] = false;
+                type = PixelType::GIEP_7;
                 break;
             case COLOR_GREEN_8:
-                pixelMap[i] = PixelType::GIEP_8;
-                buildingMap[i] = false;
+                type = PixelType::GIEP_8;
                 break;
             case COLOR_RED:
-                pixelMap[i] = PixelType::BASIN_GATE;
-                buildingMap[i] = false;
+                type = PixelType::BASIN_GATE;
                 break;
             case COLOR_MAGENTA:
-                pixelMap[i] = PixelType::BASIN_OVERFLOW;
-                buildingMap[i] = false;
+                type = PixelType::BASIN_OVERFLOW;
                 break;
             case COLOR_PURPLE:
-                pixelMap[i] = PixelType::RIVER;
-                buildingMap[i] = false;
+                type = PixelType::RIVER;
                 break;
             default:
-                pixelMap[i] = PixelType::ACTIVE;
-                buildingMap[i] = false;
+                type = PixelType::ACTIVE;
                 break;
         }
+        pixelMap.set(i, type);
     }
     detectShapes();
-    DebugLogger::info("Bitmap loaded successfully");
+    buildRainSurfaces();
+#ifdef SURFACE_WATER_GRID
+    surfaceWater.clear();
+    buildSurfaceWaterMasks();
+#endif
+    rebuildBackground();
+    dirty = true;
+    LOG_INFO("Bitmap loaded successfully");
 }
 
 void Scene::loadDefaultScene() {
@@ -108,177 +139,292 @@ void Scene::loadDefaultScene() {
 
 PixelType Scene::getPixelType(uint8_t x, uint8_t y) const {
     if (x >= width || y >= height) {
-        DebugLogger::error("Invalid coordinates: (%u, %u)", static_cast<unsigned int>(x), static_cast<unsigned int>(y));
+        LOG_ERROR("Invalid coordinates: (%u, %u)", static_cast<unsigned int>(x), static_cast<unsigned int>(y));
         return PixelType::ACTIVE;
     }
-    return pixelMap[y * width + x];
+    return pixelMap.typeAt(y * width + x);
 }
 
 void Scene::setPixelType(uint8_t x, uint8_t y, PixelType type) {
     if (x >= width || y >= height) {
-        DebugLogger::error("Invalid coordinates: (%u, %u)", static_cast<unsigned int>(x), static_cast<unsigned int>(y));
+        LOG_ERROR("Invalid coordinates: (%u, %u)", static_cast<unsigned int>(x), static_cast<unsigned int>(y));
         return;
     }
-    pixelMap[y * width + x] = type;
-    buildingMap[y * width + x] = (type == PixelType::BUILDING);
+    pixelMap.set(y * width + x, type);
+    buildRainSurfaces();
+#ifdef SURFACE_WATER_GRID
+    buildSurfaceWaterMasks();
+#endif
+    rebuildBackground();
+    dirty = true;
+}
+
+// Rain settings take effect at the next step, as render state does at the
+// next snapshot.
+void Scene::stepRain() {
+    rainSystem.setIntensity(pending.rainIntensity.load(std::memory_order_relaxed));
+    rainSystem.setVisible(pending.rainVisible.load(std::memory_order_relaxed));
+    rainSystem.setMode(pending.rainMode.load(std::memory_order_relaxed));
+    bool moved = rainSystem.update();
+#ifdef SURFACE_WATER_GRID
+    uint8_t giepMask = pending.giepMask.load(std::memory_order_relaxed);
+    if (giepMask != surfaceGiepMask) {
+        surfaceGiepMask = giepMask;
+        buildSurfaceWaterMasks();
+    }
+    moved |= surfaceWater.step();
+    surfaceToSewer += surfaceWater.takeDrained(SceneSurfaceWater::SINK_SEWER, SurfaceWater::DROP_DEPTH);
+    surfaceToBasin += surfaceWater.takeDrained(SceneSurfaceWater::SINK_BASIN, SurfaceWater::DROP_DEPTH);
+    surfaceWater.takeDrained(SceneSurfaceWater::SINK_SOAK, SurfaceWater::DROP_DEPTH);
+#endif
+    if (moved) {
+        staged.motion++;
+    }
+}
+
+void Scene::commitRenderState() {
+    staged.timeMs = clock.now();
+    staged.sewerLevel = pending.sewerLevel.load(std::memory_order_relaxed);
+    staged.basinLevel = pending.basinLevel.load(std::memory_order_relaxed);
+    staged.giepMask = pending.giepMask.load(std::memory_order_relaxed);
+    staged.basinGateActive = pending.basinGateActive.load(std::memory_order_relaxed);
+    staged.polluted = pending.polluted.load(std::memory_order_relaxed);
+    staged.flood = pending.flood.load(std::memory_order_relaxed);
+    rainSystem.capture(staged.rain);
+#ifdef SURFACE_WATER_GRID
+    captureSurfaceWater();
+#endif
+    published.write(staged);
+}
+
+// Takes the latest snapshot and repaints the background layers it changed.
+void Scene::applyRenderState(const RenderState& next) {
+    uint8_t toggledGIEPs = next.giepMask ^ current.giepMask;
+    bool gateToggled = next.basinGateActive != current.basinGateActive;
+    dirty |= toggledGIEPs || gateToggled || next.sewerLevel != current.sewerLevel ||
+             next.basinLevel != current.basinLevel || next.polluted != current.polluted ||
+             next.flood != current.flood || next.motion != current.motion;
+    current = next;
+
+    for (uint8_t i = 0; i < 8; i++) {
+        if ((toggledGIEPs >> i) & 1) {
+            repaintBackground(giepPixels[i], static_cast<PixelType>(static_cast<int>(PixelType::GIEP_1) + i));
+        }
+    }
+    if (gateToggled) {
+        for (const auto& gate : basinGateRegions) {
+            repaintBackground(gate.ledIndices, PixelType::BASIN_GATE);
+        }
+    }
 }
 
 void Scene::update() {
-    rainSystem.update(buildingMap);
-    DebugLogger::debug("Current basin level: %.2f, Current sewer level: %.2f", basinLevel, sewerLevel);
+    published.read(latest);
+    applyRenderState(latest);
+    LOG_DEBUG("Current basin level: %.2f, Current sewer level: %.2f", toFloat(current.basinLevel), toFloat(current.sewerLevel));
     updateOverflowState();
     updateRiverFlow();
+
+    // Flood and pollution blink on a 500 ms phase computed in draw()
+    uint8_t blinkPhase = (current.timeMs / 500) % 2;
+    if ((current.flood || current.polluted) && blinkPhase != lastBlinkPhase) {
+        dirty = true;
+    }
+    lastBlinkPhase = blinkPhase;
+}
+
+bool Scene::isDirty() const {
+    return dirty;
+}
+
+void Scene::markClean() {
+    dirty = false;
 }
 
 void Scene::draw(CRGB* leds) const {
-    for (uint8_t y = 0; y < height; y++) {
-        for (uint8_t x = 0; x < width; x++) {
-            uint16_t index = matrixConfig.XY(x, y);
-            PixelType pixelType = pixelMap[y * width + x];
-            leds[index] = getColorForPixelType(pixelType);
-        }
-    }
+    memcpy(leds, backgroundCache.data(), sizeof(backgroundCache));
 
-    rainSystem.draw(leds);
+#ifdef SURFACE_WATER_GRID
+    drawSurfaceWater(leds);
+#endif
+    rainSystem.draw(current.rain, leds);
 
     // Draw sewer level
-    if (isFloodState) {
+    if (current.flood) {
         // Blink yellow for sewer during flood state
-        CRGB floodColor = (millis() / 500) % 2 == 0 ? CRGB(Brightness::FLOOD_SEWER_BRIGHTNESS, Brightness::FLOOD_SEWER_BRIGHTNESS, 0) : CRGB::Black;
-        for (const auto& point : sewerShape) {
-            uint16_t index = matrixConfig.XY(point.x, point.y);
-            leds[index] = floodColor;
+        CRGB floodColor = (current.timeMs / 500) % 2 == 0 ? CRGB(Brightness::FLOOD_SEWER_BRIGHTNESS, Brightness::FLOOD_SEWER_BRIGHTNESS, 0) : CRGB::Black;
+        for (const auto& sewer : sewerRegions) {
+            for (uint16_t index : sewer.ledIndices) {
+                leds[index] = floodColor;
+            }
         }
-        DebugLogger::debug("Drawing blinking flood state for sewer");
+        LOG_DEBUG("Drawing blinking flood state for sewer");
     } else {
-        drawWaterLevel(leds, sewerShape, sewerLevel, SEWER_COLOR, SEWER_EMPTY_COLOR);
+        for (const auto& sewer : sewerRegions) {
+            drawWaterLevel(leds, sewer, current.sewerLevel, SEWER_COLOR, SEWER_EMPTY_COLOR);
+        }
     }
 
     // Draw basin level
-    drawWaterLevel(leds, basinShape, basinLevel, BASIN_COLOR, BASIN_EMPTY_COLOR);
+    for (const auto& basin : basinRegions) {
+        drawWaterLevel(leds, basin, current.basinLevel, BASIN_COLOR, BASIN_EMPTY_COLOR);
+    }
     
     // Draw basin gate
-    for (const auto& point : basinGateShape) {
-        uint16_t index = matrixConfig.XY(point.x, point.y);
-        leds[index] = basinGateActive ? BASIN_GATE_COLOR : CRGB(Brightness::BASIN_GATE_INACTIVE_BRIGHTNESS, 0, 0);
+    CRGB gateColor = current.basinGateActive ? BASIN_GATE_COLOR : CRGB(Brightness::BASIN_GATE_INACTIVE_BRIGHTNESS, 0, 0);
+    for (const auto& gate : basinGateRegions) {
+        for (uint16_t index : gate.ledIndices) {
+            leds[index] = gateColor;
+        }
     }
 
     // Draw basin overflow and river
     if (isBasinOverflow) {
-        for (const auto& point : basinOverflowShape) {
-            uint16_t index = matrixConfig.XY(point.x, point.y);
-            leds[index] = BASIN_OVERFLOW_COLOR;
+        for (const auto& overflow : basinOverflowRegions) {
+            for (uint16_t index : overflow.ledIndices) {
+                leds[index] = BASIN_OVERFLOW_COLOR;
+            }
         }
-        DebugLogger::debug("Drawing basin overflow");
+        LOG_DEBUG("Drawing basin overflow");
     }
 
     // Draw river with flowing effect
-    drawRiver(leds);
+    for (const auto& river : riverRegions) {
+        drawRiver(leds, river);
+    }
     
-    DebugLogger::debug("Basin Gate Active: %d, Basin Overflow: %d", basinGateActive, isBasinOverflow);
+    LOG_DEBUG("Basin Gate Active: %d, Basin Overflow: %d", current.basinGateActive, isBasinOverflow);
 }
 
 void Scene::setGIEPState(uint8_t giepIndex, bool state) {
-    if (giepIndex < 8) {
-        giepStates[giepIndex] = state;
+    if (giepIndex >= 8) {
+        return;
+    }
+    uint8_t bit = 1 << giepIndex;
+    if (state) {
+        pending.giepMask.fetch_or(bit, std::memory_order_relaxed);
+    } else {
+        pending.giepMask.fetch_and(static_cast<uint8_t>(~bit), std::memory_order_relaxed);
     }
 }
 
 void Scene::setBasinGateState(bool state) {
-    basinGateActive = state;
-    DebugLogger::info("Basin Gate State set to: %d", state);
+    pending.basinGateActive.store(state, std::memory_order_relaxed);
+    LOG_INFO("Basin Gate State set to: %d", state);
+}
+
+// The background holds everything that only changes on bitmap load or on a
+// GIEP / gate toggle, so draw() can start each frame from a bulk copy. GIEP
+// and gate colours follow `current`, repainted by applyRenderState().
+void Scene::rebuildBackground() {
+    for (auto& pixels : giepPixels) {
+        pixels.clear();
+    }
+    for (uint16_t i = 0; i < width * height; i++) {
+        uint16_t index = matrixConfig.XYUnchecked(i);
+        PixelType type = pixelMap.typeAt(i);
+        backgroundCache[index] = getColorForPixelType(type);
+        if (type >= PixelType::GIEP_1 && type <= PixelType::GIEP_8) {
+            giepPixels[static_cast<int>(type) - static_cast<int>(PixelType::GIEP_1)].push_back(index);
+        }
+    }
+}
+
+void Scene::repaintBackground(const std::vector<uint16_t>& ledIndices, PixelType type) {
+    CRGB color = getColorForPixelType(type);
+    for (uint16_t index : ledIndices) {
+        backgroundCache[index] = color;
+    }
 }
 
-void Scene::setSewerLevel(float level) {
-    sewerLevel = constrain(level, 0, 1);
-    DebugLogger::debug("Sewer level set to: %.2f", sewerLevel);
+void Scene::setSewerLevel(WaterLevel level) {
+    WaterLevel newLevel = clampValue(level, GameBalance::LEVEL_EMPTY, GameBalance::LEVEL_FULL);
+    pending.sewerLevel.store(newLevel, std::memory_order_relaxed);
+    LOG_DEBUG("Sewer level set to: %.2f", toFloat(newLevel));
 }
 
-void Scene::setBasinLevel(float level) {
-    basinLevel = constrain(level, 0, 1);
-    DebugLogger::debug("Basin level set to: %.2f", basinLevel);
+void Scene::setBasinLevel(WaterLevel level) {
+    WaterLevel newLevel = clampValue(level, GameBalance::LEVEL_EMPTY, GameBalance::LEVEL_FULL);
+    pending.basinLevel.store(newLevel, std::memory_order_relaxed);
+    LOG_DEBUG("Basin level set to: %.2f", toFloat(newLevel));
 }
 
-void Scene::drawWaterLevel(CRGB* leds, const std::vector<Point>& shape, float level, CRGB fullColor, CRGB emptyColor) const {
+void Scene::drawWaterLevel(CRGB* leds, const ShapeInfo& shape, WaterLevel level, CRGB fullColor, CRGB emptyColor) const {
     if (shape.empty()) {
-        DebugLogger::warn("drawWaterLevel: Shape is empty");
+        LOG_WARN("drawWaterLevel: Shape is empty");
         return;
     }
 
-    uint8_t minY = height;
-    uint8_t maxY = 0;
-    for (const auto& point : shape) {
-        if (point.y < minY) minY = point.y;
-        if (point.y > maxY) maxY = point.y;
-    }
-
-    uint8_t totalHeight = maxY - minY + 1;
-    uint8_t filledPixels = round(level * totalHeight);
+    uint8_t totalHeight = shape.rowCount();
+    uint8_t filledPixels = roundScaled(level, totalHeight);
+    // Rows from maxY - filledPixels down to maxY are full
+    uint8_t fullRows = std::min<uint8_t>(filledPixels + 1, totalHeight);
+    uint16_t filledCount = shape.bottomRowsLedCount(fullRows);
 
-    DebugLogger::debug("drawWaterLevel: level=%.2f, minY=%d, maxY=%d, totalHeight=%d, filledPixels=%d",
-                       level, minY, maxY, totalHeight, filledPixels);
+    LOG_DEBUG("drawWaterLevel: level=%.2f, minY=%d, maxY=%d, totalHeight=%d, filledPixels=%d",
+              toFloat(level), shape.minY, shape.maxY, totalHeight, filledPixels);
 
-    int filledCount = 0;
-    int emptyCount = 0;
-
-    for (const auto& point : shape) {
-        uint16_t index = matrixConfig.XY(point.x, point.y);
-        if (point.y >= maxY - filledPixels) {
-            leds[index] = fullColor;
-            filledCount++;
-        } else {
-            leds[index] = emptyColor;
-            emptyCount++;
-        }
+    const uint16_t* indices = shape.ledIndices.data();
+    for (uint16_t i = 0; i < filledCount; i++) {
+        leds[indices[i]] = fullColor;
+    }
+    for (uint16_t i = filledCount; i < shape.size(); i++) {
+        leds[indices[i]] = emptyColor;
     }
 
-    DebugLogger::debug("drawWaterLevel: Filled pixels: %d, Empty pixels: %d", filledCount, emptyCount);
+    LOG_DEBUG("drawWaterLevel: Filled pixels: %d, Empty pixels: %d", filledCount, shape.size() - filledCount);
 }
 
-void Scene::initializePixelMap() {
-    pixelMap = new PixelType[width * height];
-    for (uint16_t i = 0; i < width * height; i++) {
-        pixelMap[i] = PixelType::ACTIVE;
-    }
-    DebugLogger::info("PixelMap initialized: %ux%u", static_cast<unsigned int>(width), static_cast<unsigned int>(height));
+void Scene::setRainIntensity(float intensity) {
+    pending.rainIntensity.store(intensity, std::memory_order_relaxed);
 }
 
-void Scene::initializeBuildingMap() {
-    buildingMap = new bool[width * height];
-    for (uint16_t i = 0; i < width * height; i++) {
-        buildingMap[i] = false;
-    }
-    DebugLogger::info("BuildingMap initialized: %ux%u", static_cast<unsigned int>(width), static_cast<unsigned int>(height));
+float Scene::getRainIntensity() const {
+    return pending.rainIntensity.load(std::memory_order_relaxed);
 }
 
-void Scene::cleanupPixelMap() {
-    delete[] pixelMap;
-    DebugLogger::info("PixelMap cleaned up");
+void Scene::setRainVisible(bool visible) {
+    pending.rainVisible.store(visible, std::memory_order_relaxed);
 }
 
-void Scene::cleanupBuildingMap() {
-    delete[] buildingMap;
-    DebugLogger::info("BuildingMap cleaned up");
+void Scene::setRainMode(RainMode mode) {
+    pending.rainMode.store(mode, std::memory_order_relaxed);
 }
 
-void Scene::setRainIntensity(float intensity) {
-    rainSystem.setIntensity(intensity);
+void Scene::resetRain() {
+    rainSystem.reset();
+#ifdef SURFACE_WATER_GRID
+    surfaceWater.clear();
+    surfaceToSewer = 0;
+    surfaceToBasin = 0;
+#endif
+    staged.motion++;
 }
 
-float Scene::getRainIntensity() const {
-    return rainSystem.getIntensity();
+uint32_t Scene::getRainRandomState() const {
+    return rainSystem.getRandomState();
 }
 
-void Scene::setRainVisible(bool visible) {
-    rainSystem.setVisible(visible);
+#ifdef SURFACE_WATER_GRID
+// Rain reaches the sewer and basin through the surface grid instead of by
+// zone; the engine's own counts are drained and dropped.
+RainImpacts Scene::takeRainImpacts() {
+    rainSystem.takeImpacts();
+    RainImpacts impacts = {};
+    impacts.counts[static_cast<uint8_t>(RainZone::SEWER)] = surfaceToSewer;
+    impacts.counts[static_cast<uint8_t>(RainZone::BASIN)] = surfaceToBasin;
+    surfaceToSewer = 0;
+    surfaceToBasin = 0;
+    return impacts;
 }
-
-void Scene::setRainMode(RainMode mode) {
-    rainSystem.setMode(mode);
+#else
+RainImpacts Scene::takeRainImpacts() {
+    return rainSystem.takeImpacts();
 }
+#endif
 
-const bool* Scene::getBuildingMap() const {
-    return buildingMap;
+const SceneBitboard& Scene::getPixelMap() const {
+    return pixelMap;
 }
 
 CRGB Scene::getColorForPixelType(PixelType type) const {
@@ -299,10 +445,10 @@ CRGB Scene::getColorForPixelType(PixelType type) const {
         case PixelType::GIEP_7:
         case PixelType::GIEP_8: {
             int index = static_cast<int>(type) - static_cast<int>(PixelType::GIEP_1);
-            return giepStates[index] ? CRGB(0, Brightness::GIEP_ACTIVE_BRIGHTNESS, 0) : CRGB(0, Brightness::GIEP_INACTIVE_BRIGHTNESS, 0);
+            return (current.giepMask >> index) & 1 ? CRGB(0, Brightness::GIEP_ACTIVE_BRIGHTNESS, 0) : CRGB(0, Brightness::GIEP_INACTIVE_BRIGHTNESS, 0);
         }
         case PixelType::BASIN_GATE:
-            return basinGateActive ? CRGB(Brightness::BASIN_GATE_BRIGHTNESS, 0, 0) : CRGB(Brightness::BASIN_GATE_INACTIVE_BRIGHTNESS, 0, 0);
+            return current.basinGateActive ? CRGB(Brightness::BASIN_GATE_BRIGHTNESS, 0, 0) : CRGB(Brightness::BASIN_GATE_INACTIVE_BRIGHTNESS, 0, 0);
         case PixelType::BASIN_OVERFLOW:
         case PixelType::RIVER:
             return CRGB::Black;
@@ -311,75 +457,198 @@ CRGB Scene::getColorForPixelType(PixelType type) const {
     }
 }
 
+std::vector<ShapeInfo>* Scene::regionsFor(PixelType type) {
+    switch (type) {
+        case PixelType::SEWER:          return &sewerRegions;
+        case PixelType::BASIN:          return &basinRegions;
+        case PixelType::BASIN_GATE:     return &basinGateRegions;
+        case PixelType::BASIN_OVERFLOW: return &basinOverflowRegions;
+        case PixelType::RIVER:          return &riverRegions;
+        default:                        return nullptr;
+    }
+}
+
+// Two-pass connected-component labeling (4-connected) over the pixel map,
+// with union-find on provisional labels held in static scratch arrays.
 void Scene::detectShapes() {
-    sewerShape.clear();
-    basinShape.clear();
-    basinGateShape.clear();
-    basinOverflowShape.clear();
-    riverShape.clear();
+    for (PixelType type : {PixelType::SEWER, PixelType::BASIN, PixelType::BASIN_GATE,
+                           PixelType::BASIN_OVERFLOW, PixelType::RIVER}) {
+        regionsFor(type)->clear();
+    }
 
-    std::vector<bool> visited(width * height, false);
+    const SceneBitboard::Plane shapePixels = pixelMap.mask(PixelType::SEWER) | pixelMap.mask(PixelType::BASIN) |
+                                             pixelMap.mask(PixelType::BASIN_GATE) | pixelMap.mask(PixelType::BASIN_OVERFLOW) |
+                                             pixelMap.mask(PixelType::RIVER);
 
+    // Pass 1: provisional labels, merging with the left and upper neighbours
+    uint16_t nextLabel = 1;
     for (uint8_t y = 0; y < height; y++) {
         for (uint8_t x = 0; x < width; x++) {
-            if (!visited[y * width + x]) {
-                PixelType type = getPixelType(x, y);
-                switch (type) {
-                    case PixelType::SEWER:
-                        floodFill(x, y, PixelType::SEWER, sewerShape, visited);
-                        break;
-                    case PixelType::BASIN:
-                        floodFill(x, y, PixelType::BASIN, basinShape, visited);
-                        break;
-                    case PixelType::BASIN_GATE:
-                        floodFill(x, y, PixelType::BASIN_GATE, basinGateShape, visited);
-                        break;
-                    case PixelType::BASIN_OVERFLOW:
-                        floodFill(x, y, PixelType::BASIN_OVERFLOW, basinOverflowShape, visited);
-                        break;
-                    case PixelType::RIVER:
-                        floodFill(x, y, PixelType::RIVER, riverShape, visited);
-                        break;
-                    default:
-                        break;
+            uint16_t i = y * width + x;
+            if (!shapePixels.test(i)) {
+                regionLabels[i] = 0;
+                continue;
+            }
+            PixelType type = pixelMap.typeAt(i);
+            uint16_t left = (x > 0 && regionLabels[i - 1] && pixelMap.typeAt(i - 1) == type) ? findRoot(regionLabels[i - 1]) : 0;
+            uint16_t up = (y > 0 && regionLabels[i - width] && pixelMap.typeAt(i - width) == type) ? findRoot(regionLabels[i - width]) : 0;
+            if (left && up) {
+                uint16_t root = std::min(left, up);
+                labelParent[std::max(left, up)] = root;
+                regionLabels[i] = root;
+            } else if (left || up) {
+                regionLabels[i] = left ? left : up;
+            } else {
+                labelParent[nextLabel] = nextLabel;
+                regionLabels[i] = nextLabel++;
+            }
+        }
+    }
+
+    // Pass 2: resolve labels to regions, numbered in raster order of their first pixel
+    for (uint16_t label = 1; label < nextLabel; label++) {
+        labelParent[label] = findRoot(label);
+    }
+    for (uint16_t i = 0; i < width * height; i++) {
+        regionLabels[i] = labelParent[regionLabels[i]];
+    }
+    for (uint16_t label = 1; label < nextLabel; label++) {
+        labelParent[label] = NO_REGION;  // Reused as root -> index into the type's regions
+    }
+
+    uint16_t regionCount = 0;
+    for (uint8_t y = 0; y < height; y++) {
+        for (uint8_t x = 0; x < width; x++) {
+            uint16_t root = regionLabels[y * width + x];
+            if (!root) {
+                continue;
+            }
+            std::vector<ShapeInfo>& regions = *regionsFor(pixelMap.typeAt(y * width + x));
+            if (labelParent[root] == NO_REGION) {
+                labelParent[root] = regions.size();
+                regions.emplace_back();
+                ShapeInfo& region = regions.back();
+                region.id = regionCount++;
+                region.minX = x;
+                region.maxX = x;
+                region.minY = y;
+                region.maxY = y;
+            }
+            ShapeInfo& region = regions[labelParent[root]];
+            region.minX = std::min(region.minX, x);
+            region.maxX = std::max(region.maxX, x);
+            region.maxY = y;
+        }
+    }
+
+    // Bucket LED indices by row, bottom row first
+    for (int y = height - 1; y >= 0; y--) {
+        for (uint8_t x = 0; x < width; x++) {
+            uint16_t root = regionLabels[y * width + x];
+            if (root) {
+                (*regionsFor(pixelMap.typeAt(y * width + x)))[labelParent[root]].ledIndices.push_back(matrixConfig.XYUnchecked(x, y));
+            }
+        }
+        for (PixelType type : {PixelType::SEWER, PixelType::BASIN, PixelType::BASIN_GATE,
+                               PixelType::BASIN_OVERFLOW, PixelType::RIVER}) {
+            for (auto& region : *regionsFor(type)) {
+                if (y >= region.minY && y <= region.maxY) {
+                    region.rowEnd.push_back(region.ledIndices.size());
                 }
             }
         }
     }
 
-    DebugLogger::info("Shapes detected: Sewer(%d), Basin(%d), Basin Gate(%d), Basin Overflow(%d), River(%d)",
-                      sewerShape.size(), basinShape.size(), basinGateShape.size(), basinOverflowShape.size(), riverShape.size());
+    LOG_INFO("Regions detected: Sewer(%d), Basin(%d), Basin Gate(%d), Basin Overflow(%d), River(%d)",
+             sewerRegions.size(), basinRegions.size(), basinGateRegions.size(), basinOverflowRegions.size(), riverRegions.size());
 }
 
-void Scene::floodFill(uint8_t startX, uint8_t startY, PixelType targetType, std::vector<Point>& shape, std::vector<bool>& visited) {
-    std::stack<Point> stack;
-    stack.push(Point(startX, startY));
-
-    while (!stack.empty()) {
-        Point p = stack.top();
-        stack.pop();
+// Rain lands on roofs, GIEPs, sewers and basins. Each column lists its runs of
+// such cells top to bottom, so the rain engine never reads the map per step.
+void Scene::buildRainSurfaces() {
+    const SceneBitboard::Plane surfacePixels = pixelMap.mask(PixelType::BUILDING) | pixelMap.giepMask() |
+                                               pixelMap.mask(PixelType::SEWER) | pixelMap.mask(PixelType::BASIN);
+    // Static: at a run per row the table is about 2 KB, too much for a task stack
+    static RainSurfaceTable table;
+    for (uint8_t x = 0; x < width; x++) {
+        ColumnSurfaces& column = table[x];
+        column.count = 0;
+        for (uint8_t y = 0; y < height; y++) {
+            uint16_t i = y * width + x;
+            if (!surfacePixels.test(i)) {
+                continue;
+            }
+            PixelType type = pixelMap.typeAt(i);
+            RainSurface* last = column.count ? &column.runs[column.count - 1] : nullptr;
+            if (last && last->type == type && last->bottom + 1 == y) {
+                last->bottom = y;
+            } else {
+                // A run takes at least one row, so a column never holds more than MAX_RUNS
+                column.runs[column.count++] = RainSurface{y, y, type};
+            }
+        }
+    }
+    rainSystem.setSurfaces(table);
+}
 
-        if (p.x >= width || p.y >= height || visited[p.y * width + p.x] || getPixelType(p.x, p.y) != targetType) {
-            continue;
+#ifdef SURFACE_WATER_GRID
+// Water stands anywhere but in buildings. Sewer and basin cells take it in;
+// active GIEPs and the river soak it up.
+void Scene::buildSurfaceWaterMasks() {
+    const SceneBitboard::Plane sewer = pixelMap.mask(PixelType::SEWER);
+    const SceneBitboard::Plane basin = pixelMap.mask(PixelType::BASIN);
+    SceneBitboard::Plane soak = pixelMap.mask(PixelType::RIVER);
+    for (uint8_t i = 0; i < 8; i++) {
+        if ((surfaceGiepMask >> i) & 1) {
+            soak = soak | pixelMap.mask(static_cast<PixelType>(static_cast<int>(PixelType::GIEP_1) + i));
         }
+    }
+    for (uint8_t y = 0; y < height; y++) {
+        surfaceWater.setOpenRow(y, ~static_cast<uint64_t>(pixelMap.buildingRow(y)));
+        surfaceWater.setSinkRow(SceneSurfaceWater::SINK_SEWER, y, SceneBitboard::rowOf(sewer, y));
+        surfaceWater.setSinkRow(SceneSurfaceWater::SINK_BASIN, y, SceneBitboard::rowOf(basin, y));
+        surfaceWater.setSinkRow(SceneSurfaceWater::SINK_SOAK, y, SceneBitboard::rowOf(soak, y));
+    }
+}
 
-        shape.emplace_back(p.x, p.y);
-        visited[p.y * width + p.x] = true;
+void Scene::captureSurfaceWater() {
+    memset(staged.surfaceDepth, 0, sizeof(staged.surfaceDepth));
+    for (uint8_t y = 0; y < height; y++) {
+        uint64_t cells = surfaceWater.wetRow(y);
+        while (cells) {
+            uint8_t x = __builtin_ctzll(cells);
+            cells &= cells - 1;
+            staged.surfaceDepth[y][x] = surfaceWater.depthAt(x, y) >> 8;
+        }
+    }
+}
 
-        stack.push(Point(p.x + 1, p.y));
-        stack.push(Point(p.x - 1, p.y));
-        stack.push(Point(p.x, p.y + 1));
-        stack.push(Point(p.x, p.y - 1));
+// Standing water tints the street cells; sinks are drawn by their own layers.
+void Scene::drawSurfaceWater(CRGB* leds) const {
+    const SceneBitboard::Plane streets = pixelMap.mask(PixelType::ACTIVE);
+    const CRGB waterColor(0, 0, Brightness::SURFACE_WATER_BRIGHTNESS);
+    for (uint8_t y = 0; y < height; y++) {
+        uint64_t cells = SceneBitboard::rowOf(streets, y);
+        while (cells) {
+            uint8_t x = __builtin_ctzll(cells);
+            cells &= cells - 1;
+            if (current.surfaceDepth[y][x]) {
+                uint16_t index = matrixConfig.XYUnchecked(x, y);
+                leds[index] = blend(leds[index], waterColor, current.surfaceDepth[y][x]);
+            }
+        }
     }
 }
+#endif
 
 void Scene::updateOverflowState() {
     bool previousOverflowState = isBasinOverflow;
-    isBasinOverflow = (basinLevel >= GameBalance::OVERFLOW_ACTIVATION_THRESHOLD);
+    isBasinOverflow = (current.basinLevel >= GameBalance::OVERFLOW_ACTIVATION_THRESHOLD);
     
     if (isBasinOverflow != previousOverflowState) {
-        DebugLogger::info("Basin overflow state changed: %d -> %d (Basin level: %.2f)", 
-                          previousOverflowState, isBasinOverflow, basinLevel);
+        dirty = true;
+        LOG_INFO("Basin overflow state changed: %d -> %d (Basin level: %.2f)", 
+                 previousOverflowState, isBasinOverflow, toFloat(current.basinLevel));
     }
 }
 
@@ -388,45 +657,42 @@ CRGB Scene::getSewerColor() const {
 }
 
 void Scene::updateRiverFlow() {
-    riverFlowOffset = (riverFlowOffset + 1);
+    uint8_t offset = static_cast<uint8_t>(current.timeMs / Animation::RIVER_FLOW_PERIOD_MS);
+    // The flowing animation moves once per period; a polluted river only blinks
+    if (offset != riverFlowOffset && !riverRegions.empty() && !current.polluted) {
+        dirty = true;
+    }
+    riverFlowOffset = offset;
 }
 
-void Scene::drawRiver(CRGB* leds) const {
-    if (riverShape.empty()) return;
-
-    uint8_t minY = height;
-    uint8_t maxY = 0;
-    for (const auto& point : riverShape) {
-        if (point.y < minY) minY = point.y;
-        if (point.y > maxY) maxY = point.y;
+void Scene::drawRiver(CRGB* leds, const ShapeInfo& river) const {
+    uint8_t animatedLevels = std::min(river.rowCount(), static_cast<uint8_t>(3));
+    uint16_t animatedCount = river.bottomRowsLedCount(animatedLevels);
+    const uint16_t* indices = river.ledIndices.data();
+
+    bool shouldBlink = current.polluted; // Changed: Only blink when polluted, not during basin overflow
+    if (shouldBlink) {
+        // Blink the entire river for pollution
+        CRGB riverColor = (current.timeMs / 500) % 2 == 0 ? CRGB(Brightness::RIVER_BRIGHTNESS, 0, Brightness::RIVER_BRIGHTNESS) : CRGB::Black;
+        for (uint16_t i = 0; i < river.size(); i++) {
+            leds[indices[i]] = riverColor;
+        }
+        return;
     }
 
-    uint8_t totalHeight = maxY - minY + 1;
-    uint8_t animatedLevels = std::min(totalHeight, static_cast<uint8_t>(3));
-
-    bool shouldBlink = isPolluted; // Changed: Only blink when polluted, not during basin overflow
-    CRGB riverColor = shouldBlink ? CRGB(Brightness::RIVER_BRIGHTNESS, 0, Brightness::RIVER_BRIGHTNESS) : CRGB(0, 0, Brightness::RIVER_BRIGHTNESS);
-
-    for (const auto& point : riverShape) {
-        uint16_t index = matrixConfig.XY(point.x, point.y);
-        
-        if (shouldBlink) {
-            // Blink the entire river for pollution
-            leds[index] = (millis() / 500) % 2 == 0 ? riverColor : CRGB::Black;
-        } else {
-            if (point.y >= maxY - animatedLevels + 1) {
-                // Animated part of the river
-                uint8_t brightness = sin8((width - point.x) * 25 + riverFlowOffset * 5);
-                brightness = map(brightness, 0, 255, 70, 255);
-                leds[index] = CRGB(0, 0, brightness);
-            } else {
-                // Non-animated top line of the river
-                leds[index] = CRGB::Black;
-            }
-        }
+    // Animated part of the river
+    for (uint16_t i = 0; i < animatedCount; i++) {
+        uint8_t x = matrixConfig.coordOf(indices[i]).x;
+        uint8_t brightness = sin8((width - x) * 25 + riverFlowOffset * Animation::RIVER_FLOW_STEP);
+        brightness = map(brightness, 0, 255, 70, 255);
+        leds[indices[i]] = CRGB(0, 0, brightness);
+    }
+    // Non-animated top line of the river
+    for (uint16_t i = animatedCount; i < river.size(); i++) {
+        leds[indices[i]] = CRGB::Black;
     }
 }
 
 void Scene::setPollutionState(bool polluted) {
-    isPolluted = polluted;
+    pending.polluted.store(polluted, std::memory_order_relaxed);
 }
\ No newline at end of file
@@ -8,24 +8,10 @@
 #include "config.h"
 #include "game_config.h"
 #include "RainSystem.h"
-
-enum class PixelType {
-    ACTIVE,
-    BUILDING,
-    SEWER,
-    BASIN,
-    GIEP_1,
-    GIEP_2,
-    GIEP_3,
-    GIEP_4,
-    GIEP_5,
-    GIEP_6,
-    GIEP_7,
-    GIEP_8,
-    BASIN_GATE,
-    BASIN_OVERFLOW,
-    RIVER
-};
+#include "PixelBitboard.h"
+#include "SimClock.h"
+#include "XorShiftRandom.h"
+#include "SeqLock.h"
 
 struct Point {
     uint8_t x;
@@ -37,9 +23,50 @@ struct Point {
     }
 };
 
+// Geometry of one connected region, computed once by detectShapes(). LED indices
+// are bucketed by row from the bottom row up, so a water fill is a prefix write.
+struct ShapeInfo {
+    uint16_t id;  // Unique across all regions of the scene, in raster order
+    uint8_t minX;
+    uint8_t maxX;
+    uint8_t minY;
+    uint8_t maxY;
+    std::vector<uint16_t> ledIndices;  // Bottom row first
+    std::vector<uint16_t> rowEnd;      // rowEnd[k]: end of the k-th row from the bottom in ledIndices
+
+    bool empty() const { return ledIndices.empty(); }
+    size_t size() const { return ledIndices.size(); }
+    uint8_t rowCount() const { return static_cast<uint8_t>(rowEnd.size()); }
+    // Number of LEDs in the bottom `rows` rows
+    uint16_t bottomRowsLedCount(uint8_t rows) const { return rows ? rowEnd[rows - 1] : 0; }
+};
+
+// Everything the game decides about a frame. The game task publishes one
+// snapshot per tick; the LED task draws from the latest one, so a frame
+// depends on the snapshot alone and not on when the LED task ran.
+struct RenderState {
+    uint32_t timeMs;  // Clock at the tick; sets the blink and river phases
+    uint32_t motion;  // Changes whenever rain or surface water moved
+    WaterLevel sewerLevel;
+    WaterLevel basinLevel;
+    uint8_t giepMask;  // Bit i: GIEP i active
+    bool basinGateActive;
+    bool polluted;
+    bool flood;
+    RainFrame rain;
+#ifdef SURFACE_WATER_GRID
+    uint8_t surfaceDepth[MATRIX_HEIGHT][MATRIX_WIDTH];  // High byte of each cell's depth
+#endif
+};
+
+// The setters stage render state from the game and button tasks and
+// commitRenderState() publishes it. stepRain() and takeRainImpacts() run on
+// the game task, inside its fixed simulation steps. update(), draw() and the
+// dirty flag belong to the LED task. Map changes (loadBitmap, setPixelType)
+// happen before the tasks start.
 class Scene {
 public:
-    Scene(const MatrixConfig& config);
+    Scene(const MainMatrixConfig& config, const SimClock& clock, XorShiftRandom& rng);
     ~Scene();
     void loadBitmap(const uint32_t* bitmap, uint8_t width, uint8_t height);
     void loadDefaultScene();
@@ -47,49 +74,89 @@ public:
     void setPixelType(uint8_t x, uint8_t y, PixelType type);
     void update();
     void draw(CRGB* leds) const;
+    // Advances the rain, and the surface water when built in, one fixed step
+    // with the staged rain settings.
+    void stepRain();
+    // Publishes the staged state as one snapshot; called by the game task
+    // once per tick.
+    void commitRenderState();
     void setGIEPState(uint8_t giepIndex, bool state);
     void setBasinGateState(bool state);
-    void setSewerLevel(float level);
-    void setBasinLevel(float level);
+    void setSewerLevel(WaterLevel level);
+    void setBasinLevel(WaterLevel level);
     void setRainIntensity(float intensity);
     float getRainIntensity() const;
     void setRainVisible(bool visible); 
     void setRainMode(RainMode mode);
+    RainImpacts takeRainImpacts();
+    // Clears the drops, their pending impacts and any surface water; game task.
+    void resetRain();
+    uint32_t getRainRandomState() const;
     CRGB getSewerColor() const;
     void setPollutionState(bool polluted);
-    const bool* getBuildingMap() const;
+    const SceneBitboard& getPixelMap() const;
     void setFloodState(bool state);
+    // True when something visible changed since the last markClean().
+    bool isDirty() const;
+    void markClean();
 
 private:
-    const MatrixConfig& matrixConfig;
-    PixelType* pixelMap;
-    bool* buildingMap;
+    const MainMatrixConfig& matrixConfig;
+    const SimClock& clock;
+    SceneBitboard pixelMap;
     uint8_t width;
     uint8_t height;
-    std::array<bool, 8> giepStates;
-    bool basinGateActive;
-    float sewerLevel;
-    float basinLevel;
+    // Staged by the setters, read by commitRenderState()
+    struct PendingRenderState {
+        std::atomic<WaterLevel> sewerLevel;
+        std::atomic<WaterLevel> basinLevel;
+        std::atomic<float> rainIntensity;
+        std::atomic<RainMode> rainMode;
+        std::atomic<uint8_t> giepMask;
+        std::atomic<bool> basinGateActive;
+        std::atomic<bool> polluted;
+        std::atomic<bool> flood;
+        std::atomic<bool> rainVisible;
+    } pending;
+    SeqLock<RenderState> published;
+    RenderState staged;   // Built by commitRenderState(); game task only
+    RenderState latest;   // Read buffer for update(); LED task only
+    RenderState current;  // Latest snapshot taken by update(); LED task only
+    std::array<CRGB, NUM_LEDS> backgroundCache;  // Static layer in LED order, painted for `current`
+    std::array<std::vector<uint16_t>, 8> giepPixels;               // LED indices per GIEP
     bool isBasinOverflow;
-    std::vector<Point> sewerShape;
-    std::vector<Point> basinShape;
-    std::vector<Point> basinGateShape;
-    std::vector<Point> basinOverflowShape;
-    std::vector<Point> riverShape;
+    // Connected regions per pixel type; a map may hold several of each
+    std::vector<ShapeInfo> sewerRegions;
+    std::vector<ShapeInfo> basinRegions;
+    std::vector<ShapeInfo> basinGateRegions;
+    std::vector<ShapeInfo> basinOverflowRegions;
+    std::vector<ShapeInfo> riverRegions;
     uint8_t riverFlowOffset;
-    bool isPolluted;
-    bool isFloodState;
-    RainSystem rainSystem;
+    bool dirty;
+    uint8_t lastBlinkPhase;
+    RainSystem rainSystem;  // Stepped by the game task
+#ifdef SURFACE_WATER_GRID
+    SceneSurfaceWater surfaceWater;  // Stepped by the game task
+    uint8_t surfaceGiepMask;         // GIEPs the sink masks were built for
+    // Drop-equivalents drained into the sewer and basin since the last take
+    uint16_t surfaceToSewer;
+    uint16_t surfaceToBasin;
+#endif
 
-    void initializePixelMap();
-    void initializeBuildingMap();
-    void cleanupPixelMap();
-    void cleanupBuildingMap();
+    void applyRenderState(const RenderState& next);
     CRGB getColorForPixelType(PixelType type) const;
-    void drawWaterLevel(CRGB* leds, const std::vector<Point>& shape, float level, CRGB fullColor, CRGB emptyColor) const;
+    void rebuildBackground();
+    void repaintBackground(const std::vector<uint16_t>& ledIndices, PixelType type);
+    void drawWaterLevel(CRGB* leds, const ShapeInfo& shape, WaterLevel level, CRGB fullColor, CRGB emptyColor) const;
     void detectShapes();
-    void floodFill(uint8_t startX, uint8_t startY, PixelType targetType, std::vector<Point>& shape, std::vector<bool>& visited);
+    void buildRainSurfaces();
+#ifdef SURFACE_WATER_GRID
+    void buildSurfaceWaterMasks();
+    void captureSurfaceWater();
+    void drawSurfaceWater(CRGB* leds) const;
+#endif
+    std::vector<ShapeInfo>* regionsFor(PixelType type);
     void updateOverflowState();
     void updateRiverFlow();
-    void drawRiver(CRGB* leds) const;
+    void drawRiver(CRGB* leds, const ShapeInfo& river) const;
 };
\ No newline at end of file
@@ -3,46 +3,66 @@
 
 using namespace GameConfig;
 
-SecondaryLEDHandler::SecondaryLEDHandler() 
-    : endGameState(SecondaryLEDZone::NONE), rainLevel(RainLevel::NONE), lastBlinkTime(0), floodZoneColor(CRGB::Blue) {
-    zoneStates.fill(false);
-    DebugLogger::debug("SecondaryLEDHandler initialized");
+SecondaryLEDHandler::SecondaryLEDHandler(const SimClock& clock)
+    : clock(clock), controller(nullptr), zoneMask(0), endGameState(SecondaryLEDZone::NONE), rainLevel(RainLevel::NONE),
+      floodZoneColor(CRGB::Blue), dirty(true), shownEndGameState(SecondaryLEDZone::NONE), lastBlinkTime(0) {
+    leds.fill(CRGB::Black);
+    lastFrame.fill(CRGB::Black);
+    LOG_DEBUG("SecondaryLEDHandler initialized");
 }
 
 void SecondaryLEDHandler::begin() {
-    FastLED.addLeds<WS2813, SECONDARY_LED_PIN, GRB>(leds.data(), SECONDARY_LED_COUNT);
-    FastLED.clear();
-    FastLED.show();
-    DebugLogger::debug("SecondaryLEDHandler begun");
+    controller = &FastLED.addLeds<WS2813, SECONDARY_LED_PIN, GRB>(leds.data(), SECONDARY_LED_COUNT);
+    controller->showLeds(FastLED.getBrightness());  // Strip starts out black
+    LOG_DEBUG("SecondaryLEDHandler begun");
 }
 
-void SecondaryLEDHandler::update() {
-    if (endGameState != SecondaryLEDZone::NONE) {
-        updateEndGameState();
-    } else {
+bool SecondaryLEDHandler::update() {
+    bool stateChanged = dirty.exchange(false, std::memory_order_acquire);
+    SecondaryLEDZone state = endGameState.load(std::memory_order_relaxed);
+    if (state != shownEndGameState) {
+        shownEndGameState = state;
+        lastBlinkTime = clock.now();
+    }
+    if (state != SecondaryLEDZone::NONE) {
+        // Blinks, so composited every call. Zones the animation skips keep
+        // their last colour, apart from the rain indicators.
+        updateRainLevelIndicators();
+        updateEndGameState(state);
+    } else if (stateChanged) {
         updateNormalState();
+    } else {
+        return false;
     }
-    FastLED.show();
-    DebugLogger::debug("SecondaryLEDHandler updated");
+    bool changed = leds != lastFrame;
+    if (changed) {
+        lastFrame = leds;
+    }
+    LOG_DEBUG("SecondaryLEDHandler updated");
+    return changed;
 }
 
 void SecondaryLEDHandler::setFloodZoneColor(uint8_t r, uint8_t g, uint8_t b) {
-    floodZoneColor = CRGB(r, g, b);
-    DebugLogger::debug("Flood zone color set to (%d, %d, %d)", r, g, b);
+    uint32_t color = (static_cast<uint32_t>(r) << 16) | (static_cast<uint32_t>(g) << 8) | b;
+    if (floodZoneColor.exchange(color, std::memory_order_relaxed) != color) {
+        dirty.store(true, std::memory_order_release);
+    }
+    LOG_DEBUG("Flood zone color set to (%d, %d, %d)", r, g, b);
 }
 
 void SecondaryLEDHandler::updateNormalState() {
+    uint32_t mask = zoneMask.load(std::memory_order_relaxed);
     for (size_t zone = 0; zone < NUM_ZONES; zone++) {
-        if (zoneStates[zone]) {
+        if ((mask >> zone) & 1) {
             for (int i = 0; i < LEDS_PER_ZONE; i++) {
                 leds[zone * LEDS_PER_ZONE + i] = CRGB(GET_SECONDARY_LED_COLOR(zone, i));
             }
-            DebugLogger::debug("Zone %d LEDs turned on", zone);
+            LOG_DEBUG("Zone %d LEDs turned on", zone);
         } else {
             for (int i = 0; i < LEDS_PER_ZONE; i++) {
                 leds[zone * LEDS_PER_ZONE + i] = CRGB::Black;
             }
-            DebugLogger::debug("Zone %d LEDs turned off", zone);
+            LOG_DEBUG("Zone %d LEDs turned off", zone);
         }
     }
     updateRainLevelIndicators();
@@ -51,50 +71,58 @@ void SecondaryLEDHandler::updateNormalState() {
 void SecondaryLEDHandler::setZoneState(SecondaryLEDZone zone, bool state) {
     uint8_t index = getZoneIndexFromBitmap(zone);
     if (index < NUM_ZONES) {
-        zoneStates[index] = state;
-        DebugLogger::debug("Zone %d state set to %d", index, state);
+        uint32_t bit = 1u << index;
+        uint32_t previous = state ? zoneMask.fetch_or(bit, std::memory_order_relaxed)
+                                  : zoneMask.fetch_and(~bit, std::memory_order_relaxed);
+        if (((previous & bit) != 0) != state) {
+            dirty.store(true, std::memory_order_release);
+            LOG_DEBUG("Zone %d state set to %d", index, state);
+        }
     } else {
-        DebugLogger::error("Invalid zone index: %d", index);
+        LOG_ERROR("Invalid zone index: %d", index);
     }
 }
 
 void SecondaryLEDHandler::setRainLevel(RainLevel level) {
-    rainLevel = level;
-    DebugLogger::debug("Rain level set to %d", static_cast<int>(level));
-    updateRainLevelIndicators();
+    if (rainLevel.exchange(level, std::memory_order_relaxed) != level) {
+        dirty.store(true, std::memory_order_release);
+        LOG_DEBUG("Rain level set to %d", static_cast<int>(level));
+    }
 }
 
+// The blink restarts when update() first sees the new state.
 void SecondaryLEDHandler::setEndGameState(SecondaryLEDZone state) {
-    endGameState = state;
-    lastBlinkTime = millis();
-    DebugLogger::debug("End game state set to %d", static_cast<int>(state));
+    if (endGameState.exchange(state, std::memory_order_relaxed) != state) {
+        dirty.store(true, std::memory_order_release);
+        LOG_DEBUG("End game state set to %d", static_cast<int>(state));
+    }
 }
 
-void SecondaryLEDHandler::updateEndGameState() {
-    unsigned long currentTime = millis();
+void SecondaryLEDHandler::updateEndGameState(SecondaryLEDZone state) {
+    unsigned long currentTime = clock.now();
+    // Blink phases count from when update() first showed this end state
     bool blinkOn = ((currentTime - lastBlinkTime) / Animation::BLINK_DURATION) % 2 == 0;
-    lastBlinkTime = currentTime;  // Update lastBlinkTime every call
 
-    DebugLogger::debug("Updating end game state. EndGameState: %d, BlinkOn: %d, CurrentTime: %lu, LastBlinkTime: %lu", 
-                       static_cast<int>(endGameState), blinkOn, currentTime, lastBlinkTime);
+    LOG_DEBUG("Updating end game state. EndGameState: %d, BlinkOn: %d, CurrentTime: %lu, LastBlinkTime: %lu", 
+              static_cast<int>(state), blinkOn, currentTime, lastBlinkTime);
 
     CRGB endGameColor;
-    switch (endGameState) {
+    switch (state) {
         case SecondaryLEDZone::WIN:
             endGameColor = CRGB::Cyan;
             break;
         case SecondaryLEDZone::FLOOD_DEATH:
-            endGameColor = floodZoneColor;
+            endGameColor = CRGB(floodZoneColor.load(std::memory_order_relaxed));
             break;
         case SecondaryLEDZone::POLLUTION_DEATH:
             endGameColor = CRGB::Red;
             break;
         default:
-            DebugLogger::error("Invalid end game state: %d", static_cast<int>(endGameState));
+            LOG_ERROR("Invalid end game state: %d", static_cast<int>(state));
             return;
     }
 
-    if (endGameState == SecondaryLEDZone::WIN) {
+    if (state == SecondaryLEDZone::WIN) {
         // Blink WIN_ZONE and all GIEP zones
         uint8_t winIndex = getZoneIndexFromBitmap(SecondaryLEDZone::WIN);
 
@@ -112,9 +140,9 @@ void SecondaryLEDHandler::updateEndGameState() {
             for (int i = 0; i < LEDS_PER_ZONE; i++) {
                 leds[zone * LEDS_PER_ZONE + i] = blinkOn ? zoneColor : CRGB::Black;
             }
-            DebugLogger::debug("Zone %d (%s) set to %s, Color: (%d, %d, %d)", 
-                               zone, getZoneName(currentZone), 
-                               blinkOn ? "ON" : "OFF", zoneColor.r, zoneColor.g, zoneColor.b);
+            LOG_DEBUG("Zone %d (%s) set to %s, Color: (%d, %d, %d)", 
+                      zone, getZoneName(currentZone), 
+                      blinkOn ? "ON" : "OFF", zoneColor.r, zoneColor.g, zoneColor.b);
         }
     } else {  // FLOOD_DEATH or POLLUTION_DEATH
         for (size_t zone = 0; zone < NUM_ZONES; zone++) {
@@ -126,26 +154,28 @@ void SecondaryLEDHandler::updateEndGameState() {
         }
     }
 
-    DebugLogger::debug("End game state updated");
+    LOG_DEBUG("End game state updated");
 }
 
 CRGB SecondaryLEDHandler::getColorForZone(SecondaryLEDZone zone) {
     uint8_t index = getZoneIndexFromBitmap(zone);
     if (index < NUM_ZONES) {
         if (zone == SecondaryLEDZone::FLOOD_DEATH) {
-            DebugLogger::debug("Color for FLOOD_DEATH zone: (%d, %d, %d)", floodZoneColor.r, floodZoneColor.g, floodZoneColor.b);
-            return floodZoneColor;
+            CRGB color = CRGB(floodZoneColor.load(std::memory_order_relaxed));
+            LOG_DEBUG("Color for FLOOD_DEATH zone: (%d, %d, %d)", color.r, color.g, color.b);
+            return color;
         }
         CRGB color = CRGB(GET_SECONDARY_LED_COLOR(index, 0));
-        DebugLogger::debug("Color for zone %d: (%d, %d, %d)", index, color.r, color.g, color.b);
+        LOG_DEBUG("Color for zone %d: (%d, %d, %d)", index, color.r, color.g, color.b);
         return color;
     }
-    DebugLogger::error("Invalid zone index: %d", index);
+    LOG_ERROR("Invalid zone index: %d", index);
     return CRGB::Black;
 }
 
 void SecondaryLEDHandler::updateRainLevelIndicators() {
-    DebugLogger::debug("Updating rain level indicators. Current level: %d", static_cast<int>(rainLevel));
+    RainLevel level = rainLevel.load(std::memory_order_relaxed);
+    LOG_DEBUG("Updating rain level indicators. Current level: %d", static_cast<int>(level));
     
     // Turn off all rain level indicators
     for (int i = 0; i < 3; i++) {
@@ -157,7 +187,7 @@ void SecondaryLEDHandler::updateRainLevelIndicators() {
     }
 
     // Turn on the appropriate rain level indicator based on the current rain level
-    int rainLevelInt = static_cast<int>(rainLevel);
+    int rainLevelInt = static_cast<int>(level);
     for (int i = 0; i < rainLevelInt; i++) {
         SecondaryLEDZone zone = static_cast<SecondaryLEDZone>(static_cast<int>(SecondaryLEDZone::RAIN_LEVEL_1) + i);
         uint8_t zoneIndex = getZoneIndexFromBitmap(zone);
@@ -166,7 +196,7 @@ void SecondaryLEDHandler::updateRainLevelIndicators() {
         }
     }
 
-    DebugLogger::debug("Rain level indicators updated");
+    LOG_DEBUG("Rain level indicators updated");
 }
 
 uint8_t SecondaryLEDHandler::getZoneIndexFromBitmap(SecondaryLEDZone zone) {
@@ -3,8 +3,10 @@
 #include <Arduino.h>
 #include <FastLED.h>
 #include <array>
+#include <atomic>
 #include "config.h"
 #include "game_config.h"
+#include "SimClock.h"
 
 enum class SecondaryLEDZone {
     NONE,
@@ -32,11 +34,17 @@ enum class RainLevel {
     HEAVY
 };
 
+// The setters run on the game task and only mark the strip dirty when the
+// state actually changes. update() runs on the LED task and recomposites the
+// strip only when it is dirty or an end-game animation is showing.
 class SecondaryLEDHandler {
 public:
-    SecondaryLEDHandler();
+    SecondaryLEDHandler(const SimClock& clock);
     void begin();
-    void update();
+    // Valid after begin(); the LED task pushes the strip through it.
+    CLEDController& getController() { return *controller; }
+    // Returns true when any LED differs from the last call.
+    bool update();
     void setZoneState(SecondaryLEDZone zone, bool state);
     void setRainLevel(RainLevel level);
     void setEndGameState(SecondaryLEDZone state);
@@ -47,16 +55,25 @@ private:
     static constexpr size_t SECONDARY_LED_COUNT = TOTAL_SECONDARY_LEDS;
     static constexpr size_t NUM_ZONES = SECONDARY_NUM_ZONES;
 
+    static_assert(NUM_ZONES <= 32, "zoneMask holds one bit per zone");
+
+    const SimClock& clock;
+    CLEDController* controller;
     std::array<CRGB, SECONDARY_LED_COUNT> leds;
-    std::array<bool, NUM_ZONES> zoneStates;
-    SecondaryLEDZone endGameState;
-    RainLevel rainLevel;
+    std::array<CRGB, SECONDARY_LED_COUNT> lastFrame;
+    // Written by the setters
+    std::atomic<uint32_t> zoneMask;  // Bit per zone index
+    std::atomic<SecondaryLEDZone> endGameState;
+    std::atomic<RainLevel> rainLevel;
+    std::atomic<uint32_t> floodZoneColor;  // 0xRRGGBB
+    std::atomic<bool> dirty;
+    // LED task only
+    SecondaryLEDZone shownEndGameState;
     unsigned long lastBlinkTime;
-    CRGB floodZoneColor;
 
     void updateNormalState();
-    void updateEndGameState();
+    void updateEndGameState(SecondaryLEDZone state);
     CRGB getColorForZone(SecondaryLEDZone zone);
     void updateRainLevelIndicators();
-    uint8_t getZoneIndexFromBitmap(SecondaryLEDZone zone);
+    static uint8_t getZoneIndexFromBitmap(SecondaryLEDZone zone);
 };
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+// Single-writer sequence lock for trivially copyable values. The writer
+// never waits; a reader copies the value and retries if a write overlapped,
+// so it never blocks the writer and never sees a torn value. The payload is
+// held in relaxed atomic words so the overlapping copy is well defined.
+//
+// Readers spin only while a write is in flight, one payload copy long. Keep
+// the writer at a higher priority than readers sharing its core.
+template <typename T>
+class SeqLock {
+public:
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock payload must be trivially copyable");
+
+    explicit SeqLock(const T& initial) : sequence(0) {
+        write(initial);
+    }
+
+    // Only one task may write.
+    void write(const T& value) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+        uint32_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);  // Odd: write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; i++) {
+            uint32_t word = 0;
+            memcpy(&word, bytes + i * sizeof(uint32_t), wordBytes(i));
+            words[i].store(word, std::memory_order_relaxed);
+        }
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    // Copies straight into `value`, so large payloads need no stack buffer.
+    // `value` holds garbage while a retry is pending and is consistent on return.
+    void read(T& value) const {
+        uint8_t* bytes = reinterpret_cast<uint8_t*>(&value);
+        uint32_t before;
+        uint32_t after;
+        do {
+            before = sequence.load(std::memory_order_acquire);
+            for (size_t i = 0; i < WORDS; i++) {
+                uint32_t word = words[i].load(std::memory_order_relaxed);
+                memcpy(bytes + i * sizeof(uint32_t), &word, wordBytes(i));
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+    }
+
+    T read() const {
+        T value;
+        read(value);
+        return value;
+    }
+
+private:
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    // The last word may be partly padding.
+    static constexpr size_t wordBytes(size_t i) {
+        return i + 1 < WORDS ? sizeof(uint32_t) : sizeof(T) - i * sizeof(uint32_t);
+    }
+
+    std::atomic<uint32_t> sequence;
+    std::atomic<uint32_t> words[WORDS];
+};
@@ -0,0 +1,24 @@
+#include "SimClock.h"
+
+SimClock::SimClock() : manual(false), manualNow(0) {
+}
+
+uint32_t SimClock::now() const {
+    if (manual.load(std::memory_order_acquire)) {
+        return manualNow.load(std::memory_order_relaxed);
+    }
+    return millis();
+}
+
+bool SimClock::isManual() const {
+    return manual.load(std::memory_order_relaxed);
+}
+
+void SimClock::setManual(uint32_t startMs) {
+    manualNow.store(startMs, std::memory_order_relaxed);
+    manual.store(true, std::memory_order_release);
+}
+
+void SimClock::advance(uint32_t ms) {
+    manualNow.fetch_add(ms, std::memory_order_relaxed);
+}
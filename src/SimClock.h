@@ -0,0 +1,22 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+
+// Time source for the game, scene and LED effects. Follows millis() by
+// default; in manual mode time only moves when advance() is called, so a run
+// can be replayed or simulated faster than real time.
+class SimClock {
+public:
+    SimClock();
+
+    uint32_t now() const;
+    bool isManual() const;
+
+    // Freezes the clock at startMs; from then on only advance() moves it.
+    void setManual(uint32_t startMs);
+    void advance(uint32_t ms);
+
+private:
+    std::atomic<bool> manual;
+    std::atomic<uint32_t> manualNow;
+};
@@ -0,0 +1,42 @@
+#pragma once
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+// Fixed-size lock-free queue for exactly one producer task and one consumer
+// task. Items come out in the order they went in; push() fails instead of
+// overwriting when the consumer falls CAPACITY items behind.
+template <typename T, size_t CAPACITY>
+class SpscQueue {
+public:
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+    SpscQueue() : head(0), tail(0) {}
+
+    // Producer only.
+    bool push(const T& item) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == CAPACITY) {
+            return false;
+        }
+        slots[t & (CAPACITY - 1)] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only.
+    bool pop(T& item) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = slots[h & (CAPACITY - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    T slots[CAPACITY];
+    std::atomic<uint32_t> head;  // Next slot to pop; written by the consumer
+    std::atomic<uint32_t> tail;  // Next slot to push; written by the producer
+};
@@ -1,5 +1,4 @@
 #include "StateTracker.h"
-#include <string.h>
 
 SystemState StateTracker::s_currentState = SystemState::INITIALIZING;
 
@@ -7,9 +6,7 @@ void StateTracker::setState(SystemState newState) {
     const char* oldStateStr = getStateString(s_currentState);
     const char* newStateStr = getStateString(newState);
     
-    char buffer[100];
-    snprintf(buffer, sizeof(buffer), "State changed from %s to %s", oldStateStr, newStateStr);
-    DebugLogger::info(buffer);
+    LOG_INFO("State changed from %s to %s", oldStateStr, newStateStr);
     
     s_currentState = newState;
 }
@@ -0,0 +1,200 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+// Per-cell surface water over the city map, a side view: water falls into the
+// open cell below, spreads sideways towards shallower neighbours and leaves
+// the grid through sink cells (sewer inlets, basin, soaking GIEPs).
+//
+// Depths are Q0.16 fractions of a full cell. Each pass reads one depth buffer
+// and writes the other; flows are computed per edge with truncating division,
+// so every pass conserves water exactly. Per-row bit masks of open, wet and
+// sink cells select the cells a pass touches, dry areas cost one word test.
+template <uint8_t W, uint8_t H>
+class SurfaceWaterGrid {
+public:
+    using Depth = uint16_t;
+    static constexpr Depth FULL = 0xFFFF;
+
+    enum Sink : uint8_t {
+        SINK_SEWER,
+        SINK_BASIN,
+        SINK_SOAK,  // Absorbed without being counted
+        SINK_COUNT
+    };
+
+    static_assert(W <= 64, "Row masks are 64 bits wide");
+
+    SurfaceWaterGrid() : current(0) {
+        memset(open, 0, sizeof(open));
+        memset(sinks, 0, sizeof(sinks));
+        memset(sinkRate, 0, sizeof(sinkRate));
+        clear();
+    }
+
+    void clear() {
+        memset(depth, 0, sizeof(depth));
+        memset(wet, 0, sizeof(wet));
+        memset(drained, 0, sizeof(drained));
+    }
+
+    // Cells water may occupy. Water on a cell that closes is discarded.
+    void setOpenRow(uint8_t y, uint64_t mask) {
+        open[y] = mask & ROW_MASK;
+        uint64_t lost = wet[current][y] & ~open[y];
+        forEachBit(lost, [&](uint8_t x) { depth[current][y][x] = 0; });
+        wet[current][y] &= open[y];
+    }
+
+    void setSinkRow(Sink sink, uint8_t y, uint64_t mask) { sinks[sink][y] = mask & ROW_MASK; }
+
+    // Depth a sink cell takes per step
+    void setSinkRate(Sink sink, Depth rate) { sinkRate[sink] = rate; }
+
+    // Returns the amount actually added; a closed or full cell takes less.
+    Depth addWater(uint8_t x, uint8_t y, Depth amount) {
+        if (!((open[y] >> x) & 1)) return 0;
+        Depth& cell = depth[current][y][x];
+        Depth added = amount < FULL - cell ? amount : FULL - cell;
+        cell += added;
+        if (cell) wet[current][y] |= bit(x);
+        return added;
+    }
+
+    // Returns true while any water is on the grid.
+    bool step() {
+        fall();
+        spread();
+        drain();
+        for (uint8_t y = 0; y < H; y++) {
+            if (wet[current][y]) return true;
+        }
+        return false;
+    }
+
+    Depth depthAt(uint8_t x, uint8_t y) const { return depth[current][y][x]; }
+    uint64_t wetRow(uint8_t y) const { return wet[current][y]; }
+
+    // Returns the whole multiples of `unit` drained by a sink since the last
+    // call; the remainder is kept for the next one.
+    uint32_t takeDrained(Sink sink, uint32_t unit) {
+        uint32_t units = drained[sink] / unit;
+        drained[sink] -= units * unit;
+        return units;
+    }
+
+    uint32_t totalDepth() const {
+        uint32_t total = 0;
+        for (uint8_t y = 0; y < H; y++) {
+            forEachBit(wet[current][y], [&](uint8_t x) { total += depth[current][y][x]; });
+        }
+        return total;
+    }
+
+private:
+    static constexpr uint64_t ROW_MASK = W == 64 ? ~0ULL : ((1ULL << W) - 1);
+
+    static constexpr uint64_t bit(uint8_t x) { return 1ULL << x; }
+
+    template <typename F>
+    static void forEachBit(uint64_t bits, F&& f) {
+        while (bits) {
+            f(static_cast<uint8_t>(__builtin_ctzll(bits)));
+            bits &= bits - 1;
+        }
+    }
+
+    // Cells of the target buffer that are still wet from two passes ago and
+    // not rewritten by this pass are cleared.
+    void clearStale(uint8_t y, uint64_t written) {
+        Depth* row = depth[current ^ 1][y];
+        forEachBit(wet[current ^ 1][y] & ~written, [&](uint8_t x) { row[x] = 0; });
+    }
+
+    // Water drops into the open cell below, as much as it has room for.
+    void fall() {
+        const Depth (*src)[W] = depth[current];
+        Depth (*dst)[W] = depth[current ^ 1];
+        const uint64_t* srcWet = wet[current];
+        uint64_t* dstWet = wet[current ^ 1];
+
+        for (uint8_t y = 0; y < H; y++) {
+            uint64_t fallsOut = y + 1 < H ? srcWet[y] & open[y + 1] : 0;
+            uint64_t fallsIn = y > 0 ? srcWet[y - 1] & open[y] : 0;
+            uint64_t touched = srcWet[y] | fallsIn;
+            clearStale(y, touched);
+
+            uint64_t nowWet = 0;
+            forEachBit(touched, [&](uint8_t x) {
+                Depth d = src[y][x];
+                int32_t next = d;
+                if ((fallsOut >> x) & 1) {
+                    Depth room = FULL - src[y + 1][x];
+                    next -= d < room ? d : room;
+                }
+                if ((fallsIn >> x) & 1) {
+                    Depth above = src[y - 1][x];
+                    Depth room = FULL - d;
+                    next += above < room ? above : room;
+                }
+                dst[y][x] = static_cast<Depth>(next);
+                if (next) nowWet |= bit(x);
+            });
+            dstWet[y] = nowWet;
+        }
+        current ^= 1;
+    }
+
+    // Each open horizontal edge moves a quarter of the depth difference, so a
+    // cell can at most level with its neighbours and never overfills.
+    void spread() {
+        const Depth (*src)[W] = depth[current];
+        Depth (*dst)[W] = depth[current ^ 1];
+        const uint64_t* srcWet = wet[current];
+        uint64_t* dstWet = wet[current ^ 1];
+
+        for (uint8_t y = 0; y < H; y++) {
+            uint64_t w = srcWet[y];
+            uint64_t touched = (w | (w << 1) | (w >> 1)) & open[y];
+            uint64_t leftOpen = open[y] & (open[y] << 1);   // Cell and its left neighbour open
+            uint64_t rightOpen = open[y] & (open[y] >> 1);  // Cell and its right neighbour open
+            clearStale(y, touched);
+
+            uint64_t nowWet = 0;
+            forEachBit(touched, [&](uint8_t x) {
+                int32_t d = src[y][x];
+                int32_t next = d;
+                if ((leftOpen >> x) & 1) next += (src[y][x - 1] - d) / 4;
+                if ((rightOpen >> x) & 1) next += (src[y][x + 1] - d) / 4;
+                dst[y][x] = static_cast<Depth>(next);
+                if (next) nowWet |= bit(x);
+            });
+            dstWet[y] = nowWet;
+        }
+        current ^= 1;
+    }
+
+    void drain() {
+        for (uint8_t s = 0; s < SINK_COUNT; s++) {
+            Depth rate = sinkRate[s];
+            for (uint8_t y = 0; y < H; y++) {
+                uint64_t draining = wet[current][y] & sinks[s][y];
+                forEachBit(draining, [&](uint8_t x) {
+                    Depth& cell = depth[current][y][x];
+                    Depth taken = cell < rate ? cell : rate;
+                    cell -= taken;
+                    drained[s] += taken;
+                    if (!cell) wet[current][y] &= ~bit(x);
+                });
+            }
+        }
+    }
+
+    Depth depth[2][H][W];
+    uint64_t wet[2][H];  // Nonzero cells of each buffer
+    uint64_t open[H];
+    uint64_t sinks[SINK_COUNT][H];
+    Depth sinkRate[SINK_COUNT];
+    uint32_t drained[SINK_COUNT];
+    uint8_t current;
+};
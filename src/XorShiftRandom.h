@@ -0,0 +1,32 @@
+#pragma once
+#include <stdint.h>
+
+// Seedable xorshift32 generator. The same seed gives the same sequence on the
+// host and on the device, unlike FastLED's random8().
+class XorShiftRandom {
+public:
+    explicit XorShiftRandom(uint32_t seed = 1) { setSeed(seed); }
+
+    void setSeed(uint32_t seed) {
+        state = seed ? seed : 0x9E3779B9u;  // Zero is a fixed point of xorshift
+    }
+
+    uint32_t getState() const { return state; }
+
+    uint32_t next32() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    // The high bits are the best mixed.
+    uint8_t next8() { return static_cast<uint8_t>(next32() >> 24); }
+    uint16_t next16() { return static_cast<uint16_t>(next32() >> 16); }
+
+    // Uniform in [0, limit), same scaling as random8(limit).
+    uint8_t next8(uint8_t limit) { return static_cast<uint8_t>((static_cast<uint16_t>(next8()) * limit) >> 8); }
+
+private:
+    uint32_t state;
+};
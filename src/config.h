@@ -1,6 +1,9 @@
 #pragma once
 #include <FastLED.h>
 #include "game_config.h"
+#include "MatrixConfig.h"
+#include "PixelBitboard.h"
+#include "SurfaceWater.h"
 
 // Debug configuration
 #ifdef DEBUG
@@ -17,6 +20,11 @@
 #define LED_TYPE WS2813
 #define COLOR_ORDER GRB
 #define MATRIX_ORIENTATION MatrixOrientation::TOP_LEFT_VERTICAL
+#define MATRIX_ZIGZAG true
+
+using MainMatrixConfig = MatrixConfig<MATRIX_WIDTH, MATRIX_HEIGHT, MATRIX_ORIENTATION, MATRIX_ZIGZAG>;
+using SceneBitboard = PixelBitboard<MATRIX_WIDTH, MATRIX_HEIGHT>;
+using SceneSurfaceWater = SurfaceWaterGrid<MATRIX_WIDTH, MATRIX_HEIGHT>;
 
 // MCP23017 configuration
 #define MCP23017_ADDRESS 0x20
@@ -1,5 +1,6 @@
 #pragma once
 #include <cstdint>
+#include "FixedPoint.h"
 
 namespace GameConfig {
     namespace Timing {
@@ -12,19 +13,28 @@ namespace GameConfig {
     }
 
     namespace SewerMechanics {
-        constexpr float SEWER_INCREASE_RATE_RAINING = 0.013f;
-        constexpr float SEWER_INCREASE_RATE_HEAVY = 0.02f;
-        constexpr float SEWER_INCREASE_RATE_STORM = 0.035f;
-        constexpr float GIEP_EFFECT_STRENGTH = 0.0045f;
-        constexpr float SEWER_DRAIN_RATE = 0.01f;
-        constexpr float BASIN_GATE_TRANSFER_RATE = 0.007f;
+        // Rates per second of simulated time, integrated in Simulation::STEP_MS steps
+        // of Simulation::SUBSTEPS substeps
+        constexpr float SEWER_INCREASE_RATE_RAINING = 0.3939f;
+        constexpr float SEWER_INCREASE_RATE_HEAVY = 0.6061f;
+        constexpr float SEWER_INCREASE_RATE_STORM = 1.0606f;
+        constexpr float GIEP_EFFECT_STRENGTH = 0.1364f;
+        constexpr float SEWER_DRAIN_RATE = 0.3030f;
+        constexpr float BASIN_GATE_TRANSFER_RATE = 0.2121f;
+        // Water added per raindrop landing in a zone. On the default map nearly all
+        // rain lands on GIEPs, so with none active it adds about 1.5% to the sewer
+        // inflow while RAINING and 15-17% in HEAVY and STORM; an active GIEP keeps
+        // its share out of the sewer.
+        constexpr WaterLevel RAIN_IMPACT_QUANTUM{0.001f};
     }
 
     namespace GameBalance {
-        constexpr float SEWER_OVERFLOW_THRESHOLD = 0.65f;  // Changed back to 0.65
-        constexpr float BASIN_OVERFLOW_THRESHOLD = 0.95f;  // Changed to 0.95
-        constexpr float OVERFLOW_ACTIVATION_THRESHOLD = 0.8f;  // New threshold for overflow activation
-        constexpr float WIN_THRESHOLD = 0.5f;
+        constexpr WaterLevel SEWER_OVERFLOW_THRESHOLD{0.65f};  // Changed back to 0.65
+        constexpr WaterLevel BASIN_OVERFLOW_THRESHOLD{0.95f};  // Changed to 0.95
+        constexpr WaterLevel OVERFLOW_ACTIVATION_THRESHOLD{0.8f};  // New threshold for overflow activation
+        constexpr WaterLevel WIN_THRESHOLD{0.5f};
+        constexpr WaterLevel LEVEL_EMPTY{0.0f};
+        constexpr WaterLevel LEVEL_FULL{1.0f};
     }
 
     namespace RainVisuals {
@@ -35,6 +45,7 @@ namespace GameConfig {
         constexpr float RAIN_HEAVY_MULTIPLIER = 10.0f;
         constexpr float RAIN_STORM_MULTIPLIER = 30.0f;
         constexpr uint8_t RAIN_STORM_WIND_CHANCE = 100; // 90% chance (out of 255)
+        constexpr uint8_t RAIN_MIN_DROP_SPACING = 3;    // Rows between drops spawned in one column
     }
 
     namespace Brightness {
@@ -52,10 +63,34 @@ namespace GameConfig {
         constexpr uint8_t BASIN_OVERFLOW_BRIGHTNESS = 255;
         constexpr uint8_t RIVER_BRIGHTNESS = 255;
         constexpr uint8_t FLOOD_SEWER_BRIGHTNESS = 255;  // New brightness for flood state
+        constexpr uint8_t SURFACE_WATER_BRIGHTNESS = 160;
     }
 
     namespace Animation {
         constexpr uint32_t BLINK_DURATION = 500; // milliseconds
+        constexpr uint32_t RIVER_FLOW_PERIOD_MS = 100;  // The river wave moves once per period
+        constexpr uint8_t RIVER_FLOW_STEP = 15;         // Wave phase per move; 5 per 33 ms, as when it moved every tick
+    }
+
+    // Per-cell water grid, built with -DSURFACE_WATER_GRID. Depths are Q0.16
+    // fractions of a cell; rates are per Simulation::STEP_MS step.
+    namespace SurfaceWater {
+        constexpr uint16_t DROP_DEPTH = 4096;    // Left by each landed drop; one drop's worth reaches the sewer as one impact
+        constexpr uint16_t SEWER_INTAKE = 8192;  // Per sewer cell
+        constexpr uint16_t BASIN_INTAKE = 8192;  // Per basin cell
+        constexpr uint16_t SOAK_RATE = 2048;     // Per active GIEP or river cell
+    }
+
+    namespace Simulation {
+        constexpr uint32_t RANDOM_SEED = 0x2545F491;  // Same seed and inputs give the same frames
+        constexpr uint32_t STEP_MS = 33;              // Fixed rain and hydrology timestep
+        constexpr uint8_t SUBSTEPS = 1;               // Hydrology substeps per step; rates are split evenly
+        constexpr uint8_t MAX_STEPS_PER_UPDATE = 8;   // Late updates drop time beyond this
+    }
+
+    namespace Diagnostics {
+        constexpr uint16_t INPUT_TRACE_CAPACITY = 512;  // Button events kept for the debug dump
+        constexpr uint8_t INPUT_QUEUE_CAPACITY = 32;    // Button events waiting for the next game tick; power of two
     }
 
     namespace TaskConfig {
@@ -65,5 +100,10 @@ namespace GameConfig {
         constexpr uint8_t BUTTON_TASK_PRIORITY = 3;
         constexpr uint8_t GAME_UPDATE_TASK_PRIORITY = 2;
         constexpr uint8_t LED_UPDATE_TASK_PRIORITY = 1;
+        constexpr uint32_t GAME_UPDATE_INTERVAL_MS = 33;
+        constexpr uint32_t LED_UPDATE_INTERVAL_MS = 33;
+        constexpr uint32_t LOG_DRAIN_TASK_STACK_SIZE = 3072;
+        constexpr uint8_t LOG_DRAIN_TASK_PRIORITY = 0;
+        constexpr uint32_t LOG_DRAIN_INTERVAL_MS = 20;
     }
 }
\ No newline at end of file
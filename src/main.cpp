@@ -11,12 +11,19 @@
 #include "ButtonHandler.h"
 #include "MCP23017Handler.h"
 #include "SecondaryLEDHandler.h"
+#include "FrameStats.h"
+#include "OutputScheduler.h"
+#include "SimClock.h"
+#include "XorShiftRandom.h"
 
 CRGB leds[NUM_LEDS];
-MatrixConfig matrixConfig(MATRIX_WIDTH, MATRIX_HEIGHT, MATRIX_ORIENTATION, true);
-Scene scene(matrixConfig);
-SecondaryLEDHandler secondaryLEDs;
-GameLogic gameLogic(scene, secondaryLEDs);
+MainMatrixConfig matrixConfig;
+SimClock simClock;
+XorShiftRandom rainRandom(GameConfig::Simulation::RANDOM_SEED);
+Scene scene(matrixConfig, simClock, rainRandom);
+SecondaryLEDHandler secondaryLEDs(simClock);
+GameLogic gameLogic(scene, secondaryLEDs, simClock, GameParams::defaults());
+InputTrace inputTrace;
 MCP23017Handler mcpHandler(MCP23017_ADDRESS);
 ButtonHandler buttonHandler(mcpHandler, gameLogic);
 
@@ -32,7 +39,7 @@ void buttonTask(void* parameter) {
 
 void gameUpdateTask(void* parameter) {
     TickType_t lastWakeTime = xTaskGetTickCount();
-    const TickType_t frequency = pdMS_TO_TICKS(33);  // Update every ~30fps
+    const TickType_t frequency = pdMS_TO_TICKS(GameConfig::TaskConfig::GAME_UPDATE_INTERVAL_MS);
 
     while (true) {
         gameLogic.update();
@@ -42,13 +49,25 @@ void gameUpdateTask(void* parameter) {
 
 void ledUpdateTask(void* parameter) {
     TickType_t lastWakeTime = xTaskGetTickCount();
-    const TickType_t frequency = pdMS_TO_TICKS(33);  // ~30fps
+    const TickType_t frequency = pdMS_TO_TICKS(GameConfig::TaskConfig::LED_UPDATE_INTERVAL_MS);
 
     while (true) {
         scene.update();
-        scene.draw(leds);
-        FastLED.show();
-        secondaryLEDs.update();
+        if (scene.isDirty()) {
+            scene.draw(leds);
+            scene.markClean();
+            OutputScheduler::markDirty(LedStrip::MATRIX);
+        }
+        if (secondaryLEDs.update()) {
+            OutputScheduler::markDirty(LedStrip::SECONDARY);
+        }
+
+        // Strips go out at most once per frame, and only when one changed
+        if (OutputScheduler::show()) {
+            FrameStats::recordShow();
+        } else {
+            FrameStats::recordSkippedShow();
+        }
         vTaskDelayUntil(&lastWakeTime, frequency);
     }
 }
@@ -63,35 +82,38 @@ void setup() {
     }
 
     DebugLogger::init(Serial, LogLevel::CRITICAL);
-    DebugLogger::critical("System initialized");
+    LOG_CRITICAL("System initialized");
 
     pinMode(DEBUG_BUTTON_PIN, INPUT_PULLUP);
     pinMode(BASIN_GATE_BUTTON_PIN, INPUT_PULLUP);
     pinMode(BASIN_GATE_LED_PIN, OUTPUT);
 
     mcpHandler.begin();
-    FastLED.addLeds<LED_TYPE, LED_PIN, COLOR_ORDER>(leds, NUM_LEDS).setCorrection(TypicalLEDStrip);
+    CLEDController& matrixController = FastLED.addLeds<LED_TYPE, LED_PIN, COLOR_ORDER>(leds, NUM_LEDS).setCorrection(TypicalLEDStrip);
     FastLED.setBrightness(GameConfig::Brightness::GLOBAL_BRIGHTNESS);
     FastLED.clear();
     FastLED.show();
     secondaryLEDs.begin();
+    OutputScheduler::attach(LedStrip::MATRIX, matrixController);
+    OutputScheduler::attach(LedStrip::SECONDARY, secondaryLEDs.getController());
     scene.loadDefaultScene();
+    gameLogic.setInputTrace(&inputTrace);
 
     BaseType_t result;
     result = xTaskCreatePinnedToCore(buttonTask, "ButtonTask", GameConfig::TaskConfig::BUTTON_TASK_STACK_SIZE, NULL, GameConfig::TaskConfig::BUTTON_TASK_PRIORITY, NULL, 0);
     if (result != pdPASS) {
-        DebugLogger::critical("Failed to create ButtonTask: %d", result);
+        LOG_CRITICAL("Failed to create ButtonTask: %d", result);
     }
     result = xTaskCreatePinnedToCore(gameUpdateTask, "GameUpdateTask", GameConfig::TaskConfig::GAME_UPDATE_TASK_STACK_SIZE, NULL, GameConfig::TaskConfig::GAME_UPDATE_TASK_PRIORITY, NULL, 1);
     if (result != pdPASS) {
-        DebugLogger::critical("Failed to create GameUpdateTask: %d", result);
+        LOG_CRITICAL("Failed to create GameUpdateTask: %d", result);
     }
     result = xTaskCreatePinnedToCore(ledUpdateTask, "LEDUpdateTask", GameConfig::TaskConfig::LED_UPDATE_TASK_STACK_SIZE, NULL, GameConfig::TaskConfig::LED_UPDATE_TASK_PRIORITY, NULL, 1);
     if (result != pdPASS) {
-        DebugLogger::critical("Failed to create LEDUpdateTask: %d", result);
+        LOG_CRITICAL("Failed to create LEDUpdateTask: %d", result);
     }
 
-    DebugLogger::critical("Setup complete");
+    LOG_CRITICAL("Setup complete");
 }
 
 void loop() {
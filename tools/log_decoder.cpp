@@ -0,0 +1,409 @@
+// Host-side decoder for tokenized DebugLogger output (-DLOG_TOKENIZED=1).
+//
+// Build:
+//   g++ -std=c++17 -O2 tools/log_decoder.cpp -o log_decoder
+//
+// Generate the token table from the firmware sources:
+//   ./log_decoder table src > tokens.tsv
+//
+// Decode a serial capture (file or stdin):
+//   ./log_decoder decode tokens.tsv capture.bin
+//   cat /dev/ttyACM0 | ./log_decoder decode tokens.tsv
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <regex>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Must match DebugLogger.h
+static constexpr uint32_t DROPPED_TOKEN = 0;
+static constexpr uint8_t FRAME_SYNC = 0xA0;
+
+enum class ArgKind : uint8_t { INTEGER = 0, FLOAT = 1, STRING = 2, POINTER = 3 };
+
+struct Arg {
+    ArgKind kind;
+    int64_t i;
+    double d;
+    std::string s;
+};
+
+static uint32_t tokenize(const std::string& format) {
+    uint32_t hash = 2166136261u;
+    for (char c : format) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+    }
+    return hash == DROPPED_TOKEN ? 1 : hash;
+}
+
+static const char* levelString(uint8_t level) {
+    switch (level) {
+        case 1: return "CRITICAL";
+        case 2: return "ERROR";
+        case 3: return "WARN";
+        case 4: return "INFO";
+        case 5: return "GAME_STATE";
+        case 6: return "DEBUG";
+        default: return "UNKNOWN";
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Token table
+
+static std::string unescapeLiteral(const std::string& body) {
+    std::string out;
+    for (size_t i = 0; i < body.size(); i++) {
+        if (body[i] != '\\' || i + 1 >= body.size()) {
+            out += body[i];
+            continue;
+        }
+        char c = body[++i];
+        switch (c) {
+            case 'n': out += '\n'; break;
+            case 't': out += '\t'; break;
+            case 'r': out += '\r'; break;
+            case '0': out += '\0'; break;
+            case 'x': {
+                std::string hex;
+                while (i + 1 < body.size() && isxdigit(static_cast<unsigned char>(body[i + 1])) && hex.size() < 2) {
+                    hex += body[++i];
+                }
+                out += static_cast<char>(std::stoi(hex, nullptr, 16));
+                break;
+            }
+            default: out += c; break;
+        }
+    }
+    return out;
+}
+
+static std::string escapeTable(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '\\') out += "\\\\";
+        else if (c == '\n') out += "\\n";
+        else if (c == '\t') out += "\\t";
+        else out += c;
+    }
+    return out;
+}
+
+static std::string unescapeTable(const std::string& text) {
+    std::string out;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '\\' && i + 1 < text.size()) {
+            char c = text[++i];
+            out += c == 'n' ? '\n' : c == 't' ? '\t' : c;
+        } else {
+            out += text[i];
+        }
+    }
+    return out;
+}
+
+static int buildTable(const std::vector<std::string>& roots) {
+    // LOG_<LEVEL>( followed by one or more adjacent string literals.
+    const std::regex callRegex(R"re(LOG_(CRITICAL|ERROR|WARN|INFO|GAME_STATE|DEBUG)\s*\(\s*((?:"(?:[^"\\]|\\.)*"\s*)+))re");
+    const std::regex literalRegex(R"re("((?:[^"\\]|\\.)*)")re");
+    std::map<uint32_t, std::string> table;
+    int collisions = 0;
+
+    for (const auto& root : roots) {
+        for (const auto& entry : fs::recursive_directory_iterator(root)) {
+            const std::string ext = entry.path().extension().string();
+            if (!entry.is_regular_file() || (ext != ".cpp" && ext != ".h")) {
+                continue;
+            }
+            std::ifstream file(entry.path());
+            const std::string source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+            for (std::sregex_iterator it(source.begin(), source.end(), callRegex), end; it != end; ++it) {
+                const std::string literals = (*it)[2].str();
+                std::string format;
+                for (std::sregex_iterator lit(literals.begin(), literals.end(), literalRegex); lit != end; ++lit) {
+                    format += unescapeLiteral((*lit)[1].str());
+                }
+                const uint32_t token = tokenize(format);
+                auto existing = table.find(token);
+                if (existing != table.end() && existing->second != format) {
+                    std::cerr << "Token collision " << std::hex << token << ": \"" << existing->second
+                              << "\" vs \"" << format << "\"\n";
+                    collisions++;
+                }
+                table[token] = format;
+            }
+        }
+    }
+
+    for (const auto& item : table) {
+        std::printf("%08x\t%s\n", item.first, escapeTable(item.second).c_str());
+    }
+    std::cerr << table.size() << " format strings\n";
+    return collisions ? 1 : 0;
+}
+
+static std::map<uint32_t, std::string> loadTable(const std::string& path) {
+    std::map<uint32_t, std::string> table;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t tab = line.find('\t');
+        if (tab == std::string::npos) {
+            continue;
+        }
+        table[static_cast<uint32_t>(std::stoul(line.substr(0, tab), nullptr, 16))] = unescapeTable(line.substr(tab + 1));
+    }
+    table[DROPPED_TOKEN] = "%lu log records dropped";
+    return table;
+}
+
+// ---------------------------------------------------------------------------
+// Frame decoding
+
+class Reader {
+public:
+    Reader(const std::vector<uint8_t>& data, size_t pos) : data(data), pos(pos) {}
+
+    bool byte(uint8_t& out) {
+        if (pos >= data.size()) {
+            exhausted = true;
+            return false;
+        }
+        out = data[pos++];
+        return true;
+    }
+
+    bool varint(uint64_t& out) {
+        out = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t b;
+            if (!byte(b)) return false;
+            out |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+
+    size_t position() const { return pos; }
+    bool isExhausted() const { return exhausted; }
+
+private:
+    const std::vector<uint8_t>& data;
+    size_t pos;
+    bool exhausted = false;
+};
+
+static std::string formatMessage(const std::string& format, const std::vector<Arg>& args) {
+    std::string out;
+    size_t argIndex = 0;
+    char buffer[256];
+
+    for (size_t i = 0; i < format.size(); i++) {
+        if (format[i] != '%') {
+            out += format[i];
+            continue;
+        }
+        if (i + 1 < format.size() && format[i + 1] == '%') {
+            out += '%';
+            i++;
+            continue;
+        }
+        std::string spec = "%";
+        size_t j = i + 1;
+        while (j < format.size() && std::strchr("-+ #0123456789.", format[j])) spec += format[j++];
+        // Integers arrive widened to 64 bits; only "ll" keeps them that wide on the 32-bit targets.
+        bool longLong = false;
+        while (j < format.size() && std::strchr("hlzjtL", format[j])) {
+            longLong |= format[j] == 'l' && j + 1 < format.size() && format[j + 1] == 'l';
+            j++;
+        }
+        if (j >= format.size()) break;
+        const char conversion = format[j];
+        i = j;
+
+        if (argIndex >= args.size()) {
+            out += spec + conversion;
+            continue;
+        }
+        const Arg& arg = args[argIndex++];
+        switch (conversion) {
+            case 'd': case 'i':
+                std::snprintf(buffer, sizeof(buffer), (spec + "lld").c_str(),
+                              arg.kind == ArgKind::FLOAT ? static_cast<long long>(arg.d) : static_cast<long long>(arg.i));
+                break;
+            case 'u': case 'x': case 'X': case 'o':
+                std::snprintf(buffer, sizeof(buffer), (spec + "ll" + conversion).c_str(),
+                              longLong ? static_cast<unsigned long long>(arg.i)
+                                       : static_cast<unsigned long long>(static_cast<uint32_t>(arg.i)));
+                break;
+            case 'c':
+                std::snprintf(buffer, sizeof(buffer), (spec + "c").c_str(), static_cast<int>(arg.i));
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G':
+                std::snprintf(buffer, sizeof(buffer), (spec + conversion).c_str(),
+                              arg.kind == ArgKind::FLOAT ? arg.d : static_cast<double>(arg.i));
+                break;
+            case 's':
+                std::snprintf(buffer, sizeof(buffer), (spec + "s").c_str(), arg.s.c_str());
+                break;
+            case 'p':
+                std::snprintf(buffer, sizeof(buffer), "0x%llx", static_cast<unsigned long long>(arg.i));
+                break;
+            default:
+                std::snprintf(buffer, sizeof(buffer), "%s%c", spec.c_str(), conversion);
+                break;
+        }
+        out += buffer;
+    }
+    return out;
+}
+
+static constexpr size_t FRAME_INVALID = 0;
+static constexpr size_t FRAME_INCOMPLETE = SIZE_MAX;
+
+// Returns the position after the frame, FRAME_INVALID if the bytes at pos are
+// not a frame, or FRAME_INCOMPLETE if the frame runs past the buffered data.
+static size_t decodeFrame(const std::vector<uint8_t>& data, size_t pos,
+                          const std::map<uint32_t, std::string>& table, std::string& line) {
+    Reader reader(data, pos);
+    uint8_t header;
+    if (!reader.byte(header) || (header & 0xF0) != FRAME_SYNC) return reader.isExhausted() ? FRAME_INCOMPLETE : FRAME_INVALID;
+
+    uint32_t token = 0;
+    for (int i = 0; i < 4; i++) {
+        uint8_t b;
+        if (!reader.byte(b)) return reader.isExhausted() ? FRAME_INCOMPLETE : FRAME_INVALID;
+        token |= static_cast<uint32_t>(b) << (8 * i);
+    }
+    auto format = table.find(token);
+    if (format == table.end()) return reader.isExhausted() ? FRAME_INCOMPLETE : FRAME_INVALID;
+
+    uint64_t timestamp;
+    uint8_t argCount;
+    if (!reader.varint(timestamp) || !reader.byte(argCount) || argCount > 8) return reader.isExhausted() ? FRAME_INCOMPLETE : FRAME_INVALID;
+
+    uint16_t kinds = 0;
+    for (uint8_t i = 0; i < argCount; i += 4) {
+        uint8_t b;
+        if (!reader.byte(b)) return reader.isExhausted() ? FRAME_INCOMPLETE : FRAME_INVALID;
+        kinds |= static_cast<uint16_t>(b) << (2 * i);
+    }
+
+    std::vector<Arg> args;
+    for (uint8_t i = 0; i < argCount; i++) {
+        Arg arg{static_cast<ArgKind>((kinds >> (2 * i)) & 0x03), 0, 0.0, {}};
+        uint64_t value;
+        switch (arg.kind) {
+            case ArgKind::INTEGER:
+                if (!reader.varint(value)) return reader.isExhausted() ? FRAME_INCOMPLETE : FRAME_INVALID;
+                arg.i = static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+                break;
+            case ArgKind::FLOAT: {
+                uint32_t bits = 0;
+                for (int b = 0; b < 4; b++) {
+                    uint8_t byte;
+                    if (!reader.byte(byte)) return reader.isExhausted() ? FRAME_INCOMPLETE : FRAME_INVALID;
+                    bits |= static_cast<uint32_t>(byte) << (8 * b);
+                }
+                float f;
+                std::memcpy(&f, &bits, sizeof(f));
+                arg.d = f;
+                break;
+            }
+            case ArgKind::STRING:
+                if (!reader.varint(value) || value > 64) return reader.isExhausted() ? FRAME_INCOMPLETE : FRAME_INVALID;
+                for (uint64_t c = 0; c < value; c++) {
+                    uint8_t byte;
+                    if (!reader.byte(byte)) return reader.isExhausted() ? FRAME_INCOMPLETE : FRAME_INVALID;
+                    arg.s += static_cast<char>(byte);
+                }
+                break;
+            case ArgKind::POINTER:
+                if (!reader.varint(value)) return reader.isExhausted() ? FRAME_INCOMPLETE : FRAME_INVALID;
+                arg.i = static_cast<int64_t>(value);
+                break;
+        }
+        args.push_back(arg);
+    }
+
+    line = std::to_string(timestamp) + " [" + levelString(header & 0x0F) + "] " + formatMessage(format->second, args);
+    return reader.position();
+}
+
+// Streams the input so a live serial pipe is decoded as it arrives.
+static int decode(const std::string& tablePath, std::istream& input) {
+    const auto table = loadTable(tablePath);
+    std::vector<uint8_t> data;
+    size_t skipped = 0;
+    char chunk[256];
+
+    while (input) {
+        // Take whatever is buffered; only when nothing is, block for one byte.
+        // A full-size read() would sit on a live pipe until 256 bytes came in.
+        std::streamsize count = input.readsome(chunk, sizeof(chunk));
+        if (count <= 0) {
+            input.read(chunk, 1);
+            count = input.gcount();
+            if (count <= 0) {
+                break;
+            }
+            count += std::max<std::streamsize>(input.readsome(chunk + 1, sizeof(chunk) - 1), 0);
+        }
+        data.insert(data.end(), chunk, chunk + count);
+
+        size_t pos = 0;
+        while (pos < data.size()) {
+            std::string line;
+            const size_t next = decodeFrame(data, pos, table, line);
+            if (next == FRAME_INCOMPLETE) {
+                break;
+            }
+            if (next == FRAME_INVALID) {
+                pos++;
+                skipped++;
+                continue;
+            }
+            if (skipped) {
+                std::cerr << "Skipped " << skipped << " unframed bytes\n";
+                skipped = 0;
+            }
+            std::cout << line << std::endl;
+            pos = next;
+        }
+        data.erase(data.begin(), data.begin() + pos);
+    }
+    skipped += data.size();
+    if (skipped) {
+        std::cerr << "Skipped " << skipped << " unframed bytes\n";
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 3 && std::strcmp(argv[1], "table") == 0) {
+        return buildTable(std::vector<std::string>(argv + 2, argv + argc));
+    }
+    if (argc >= 3 && std::strcmp(argv[1], "decode") == 0) {
+        if (argc >= 4) {
+            std::ifstream file(argv[3], std::ios::binary);
+            return decode(argv[2], file);
+        }
+        std::ios::sync_with_stdio(false);  // Gives std::cin its own buffer for readsome()
+        return decode(argv[2], std::cin);
+    }
+    std::cerr << "Usage:\n"
+              << "  " << argv[0] << " table <source-dir>... > tokens.tsv\n"
+              << "  " << argv[0] << " decode <tokens.tsv> [capture.bin]\n";
+    return 2;
+}